@@ -0,0 +1,60 @@
+/**
+ * @file cut.h
+ * @brief
+ * @author Nathan Zhou
+ * @date 2019-02-14
+ * @bug No known bugs.
+ */
+
+#ifndef DALS_CUT_H
+#define DALS_CUT_H
+
+#include <vector>
+#include <abc_plus.h>
+
+using namespace abc_plus;
+
+static const int CUT_SIZE_MAX = 6;
+
+struct Cut {
+    int leaves[CUT_SIZE_MAX];
+    int size;
+    int depth;
+    uint64_t sign;
+    uint64_t truth;
+};
+
+uint64_t TruthVar(int i);
+
+uint64_t TruthMask(int n_vars);
+
+uint64_t TruthExpand(uint64_t truth, const int *leaves, int size, const int *new_leaves, int new_size);
+
+class CutManager {
+public:
+    explicit CutManager(int cut_size = CUT_SIZE_MAX, int cut_limit = 8);
+
+    void Enumerate(NtkPtr ntk);
+
+    int GetCutNum(ObjPtr obj) const;
+
+    const Cut *GetCuts(ObjPtr obj) const;
+
+    int GetDepth(ObjPtr obj) const;
+
+private:
+    int cut_size_;
+    int cut_limit_;
+    std::vector<Cut> cuts_;
+    std::vector<int> cut_num_;
+    std::vector<int> depth_;
+    std::vector<const Cut *> chosen_;
+    std::vector<const uint64_t *> fanin_truths_;
+    std::vector<uint64_t> expanded_truths_;
+
+    void MergeCuts(ObjPtr node, const std::vector<ObjPtr> &fan_ins, int i, const Cut &partial);
+
+    void AddCut(ObjPtr node, const Cut &cut);
+};
+
+#endif
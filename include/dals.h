@@ -10,7 +10,17 @@
 #define DALS_DALS_H
 
 #include <map>
+#include <memory_resource>
 #include <abc_plus.h>
+#include <prob.h>
+#include <cut.h>
+#include <signature.h>
+#include <sim.h>
+#include <kernel.h>
+#include <mem.h>
+#include <push_relabel.h>
+#include <thread_pool.h>
+#include <sta.h>
 
 using namespace abc_plus;
 
@@ -29,8 +39,18 @@ public:
 
     ObjPtr GetSubstitute() const;
 
+    ObjPtr GetReplacement() const;
+
     bool IsComplemented() const;
 
+    bool IsLocalApprox() const;
+
+    const std::vector<ObjPtr> &GetLeaves() const;
+
+    unsigned GetTruth() const;
+
+    size_t GetMemBytes() const;
+
     void SetError(double err);
 
     void SetTarget(ObjPtr t);
@@ -55,6 +75,8 @@ public:
 
     ALC(ObjPtr t, ObjPtr s, bool is_complemented, double error = 1);
 
+    ALC(ObjPtr t, ObjPtr leaf_0, ObjPtr leaf_1, unsigned truth, double error = 1);
+
     ~ALC();
 
 private:
@@ -63,8 +85,56 @@ private:
     ObjPtr target_;
     ObjPtr substitute_;
     ObjPtr inv_;
+    std::vector<ObjPtr> leaves_;
+    unsigned truth_;
+    ObjPtr approx_;
     std::vector<ObjPtr> target_fan_outs_;
     std::unordered_map<ObjPtr, std::vector<ObjPtr>> target_fan_out_fan_ins_;
+
+    void SaveTargetFanouts();
+};
+
+struct EvalScratch {
+    std::vector<int> slot;
+    std::vector<ObjPtr> touched;
+    std::vector<ObjPtr> events;
+    std::vector<uint64_t> rows;
+    std::vector<uint64_t> tmp;
+    std::vector<uint64_t> err_mask;
+    std::vector<const uint64_t *> fanin_words;
+    std::vector<const ALC *> forced;
+    SigScratch sig;
+};
+
+enum class CutStrategy {
+    MaxFlow,
+    Greedy
+};
+
+/* The options of DALS as given to its setters, so they can be put back after a temporary change */
+struct DALSSettings {
+    int sim_64_cycles;
+    uint64_t seed;
+    TruthVecMode truth_vec_mode;
+    bool prob_prefilter;
+    double prob_prefilter_margin;
+    int n_partitions;
+    int pool_words;
+    int pool_finalists;
+    bool adaptive_verify;
+    int adaptive_max_k;
+    double adaptive_cluster_tol;
+    bool local_approx;
+    int cut_size;
+    int cut_limit;
+    bool transposed_sigs;
+    size_t mem_budget;
+    int n_threads;
+    FlowSolver flow_solver;
+    int flow_quantum_bits;
+    int alt_cuts;
+    double alt_cut_slack;
+    CutStrategy cut_strategy;
 };
 
 /////////////////////////////////////////////////////////////////////////////
@@ -80,19 +150,68 @@ public:
 
     NtkPtr GetApproxNtk();
 
-    void SetTargetNtk(NtkPtr ntk);
+    const ErrorReport &GetErrorReport() const;
+
+    const MemoryReport &GetMemoryReport() const;
+
+    const GoldenCache &GetGoldenCache() const;
+
+    DALSSettings GetSettings() const;
+
+    void SetSettings(const DALSSettings &settings);
+
+    void SetTargetNtk(NtkPtr ntk, bool renumber = false);
 
     void SetSim64Cycles(int sim_64_cycles);
 
+    void SetProbPrefilter(bool enable, double margin = 0.05);
+
+    void SetSeed(uint64_t seed = 0);
+
+    void SetTruthVecMode(TruthVecMode mode);
+
+    void SetPartitions(int n_partitions);
+
+    void SetPatternPool(int pool_words, int n_finalists = 16);
+
+    void SetAdaptiveVerify(bool enable, int max_k = 8, double cluster_tol = 0.005);
+
+    void SetLocalApprox(bool enable, int cut_size = CUT_SIZE_MAX, int cut_limit = 8);
+
+    void SetTransposedSigs(bool enable);
+
+    void SetMemoryBudget(size_t bytes);
+
+    void SetThreads(int n_threads = 0);
+
+    // only for single cuts, alternative cuts are always enumerated by Dinic
+    void SetFlowSolver(FlowSolver solver, int quantum_bits = 40);
+
+    void SetAltCuts(int max_cuts, double slack = 0);
+
+    void SetCutStrategy(CutStrategy strategy);
+
     //---------------------------------------------------------------------------
     // DALS Methods
     //---------------------------------------------------------------------------
-    void CalcTruthVec(bool show_progress_bar = false);
+    void CalcTruthVec(bool show_progress_bar = false, const std::vector<ObjPtr> &keep_nodes = std::vector<ObjPtr>());
 
     void CalcALCs(const std::vector<ObjPtr> &target_nodes, bool show_progress = false, int top_k = 3);
 
+    const std::vector<ALC> &GetCandALCs(ObjPtr target) const;
+
     double EstSubPairError(ObjPtr target, ObjPtr substitute);
 
+    double EstSubPairErrorOnPool(ObjPtr target, ObjPtr substitute) const;
+
+    double EstLocalApproxError(ObjPtr target, ObjPtr leaf_0, ObjPtr leaf_1, unsigned truth);
+
+    double EvalALC(const ALC &alc);
+
+    double EvalALCs(const std::vector<const ALC *> &alcs);
+
+    std::vector<int> DoALCs(std::vector<ALC *> &alcs);
+
     void Run(double err_constraint = 0.15);
 
     //---------------------------------------------------------------------------
@@ -108,11 +227,112 @@ private:
     NtkPtr target_ntk_;
     NtkPtr approx_ntk_;
     int sim_64_cycles_;
-    std::unordered_map<ObjPtr, std::vector<uint64_t>> truth_vec_;
+    int requested_sim_64_cycles_;
+    uint64_t seed_;
+    TruthVecMode truth_vec_mode_;
+    TruthVecMode requested_truth_vec_mode_;
+    SignatureStore truth_vec_;
+    SigScratch sig_scratch_;
+    EvalScratch eval_scratch_;
+    int n_threads_;
+    std::unique_ptr<ThreadPool> pool_;
+    std::vector<EvalScratch> worker_scratch_;
+    SimKernels block_kernels_;
+    SimKernels tail_kernels_;
+    SimKernels pool_kernels_;
+    GoldenCache golden_;
+    std::vector<uint64_t> po_err_;
+    std::vector<uint64_t> err_any_;
+    long long base_err_cnt_;
+    ErrorReport err_report_;
+    MemoryReport mem_report_;
+    std::vector<ObjPtr> po_drivers_;
+    std::vector<ObjPtr> s_nodes_;
+    std::vector<int> arrival_time_;
+    CriticalGraphTracker timing_;
+    CriticalFlowGraph flow_graph_;
+    std::vector<int> topo_index_;
+    std::unordered_map<ObjPtr, ProbObject> prob_info_;
+    // filled by the pool workers and read after CalcALCs, so not from the single-threaded round arena
     std::unordered_map<ObjPtr, std::vector<ALC>> cand_alcs_;
     std::unordered_map<ObjPtr, ALC> opt_alc_;
+    CountingResource flow_mem_;
+    std::pmr::monotonic_buffer_resource round_arena_;
+    bool prob_prefilter_;
+    double prob_prefilter_margin_;
+    bool local_approx_;
+    int cut_size_;
+    int cut_limit_;
+    CutManager cut_manager_;
+    int n_partitions_;
+    int pool_words_;
+    int pool_finalists_;
+    std::vector<int> pool_patterns_;
+    std::vector<int> informative_patterns_;
+    std::vector<uint64_t> pool_truth_vec_;
+    bool adaptive_verify_;
+    int adaptive_max_k_;
+    double adaptive_cluster_tol_;
+    bool transposed_sigs_;
+    bool requested_transposed_sigs_;
+    size_t mem_budget_;
+    FlowSolver flow_solver_;
+    int flow_quantum_bits_;
+    int alt_cuts_;
+    double alt_cut_slack_;
+    CutStrategy cut_strategy_;
+    std::vector<ObjPtr> sub_order_;
+    std::vector<uint64_t> sub_sigs_t_;
+    std::vector<long long> sub_err_begin_;
+    std::vector<int> sub_err_cnt_;
 
     DALS();
+
+    void PrepareALCs(const std::vector<ObjPtr> &target_nodes, bool show_progress);
+
+    void SampleMemory();
+
+    void ApplyMemoryBudget(int top_k, bool first_round);
+
+    const SimKernels &GetKernels(int n_words) const;
+
+    void CalcCandALCs(ObjPtr t_node, int top_k, std::vector<ALC> &cand_alcs, SigScratch &scratch,
+                      long long &n_pruned) const;
+
+    void CalcLocalApproxALCs(ObjPtr t_node, int arrival_time, std::vector<ALC> &cand_alcs, SigScratch &scratch) const;
+
+    double EstSubPairError(ObjPtr target, ObjPtr substitute, SigScratch &scratch) const;
+
+    double EstLocalApproxError(ObjPtr target, ObjPtr leaf_0, ObjPtr leaf_1, unsigned truth, SigScratch &scratch) const;
+
+
+    void BuildTransposedSigs(const std::vector<ObjPtr> &target_nodes);
+
+    int GetSubGroupNum(ObjPtr target) const;
+
+    void AddSubGroupErrors(const uint64_t *target_words, int group, int n_words, int *err_cnt) const;
+
+    void BuildPatternPool();
+
+    void RecordDisagreements(const std::vector<ALC> &cand_alcs);
+
+    double EvalALC(const ALC &alc, EvalScratch &scratch) const;
+
+    double EvalALCs(const ALC *const *alcs, int n_alcs, EvalScratch &scratch) const;
+
+    ALC VerifyCandALCs(const std::vector<ALC> &cand_alcs, int top_k, EvalScratch &scratch, long long &n_verified) const;
+
+    std::vector<ObjPtr> PickBestCut(const std::vector<std::vector<Edge>> &cuts);
+
+    std::vector<std::vector<Edge>> SolveMinCuts(int N, const std::pmr::vector<Edge> &edges);
+
+    std::vector<ObjPtr> CalcMinCut(const std::vector<ObjPtr> &pis_nodes_0, const std::vector<ObjPtr> &nodes_0, int top_k);
+
+    std::vector<ObjPtr> CalcPartitionedCut(const std::vector<ObjPtr> &pis_nodes_0, const std::vector<ObjPtr> &nodes_0,
+                                           int top_k);
+
+    std::vector<ObjPtr> CalcGreedyCut(const std::vector<ObjPtr> &pis_nodes_0, const std::vector<ObjPtr> &nodes_0,
+                                      int top_k);
 };
 
 #endif
@@ -10,7 +10,8 @@
 #define DALS_DINIC_H
 
 #include <vector>
-#include <queue>
+#include <cstdint>
+#include <memory_resource>
 
 struct Edge {
     int u, v;
@@ -23,7 +24,7 @@ struct Edge {
 
 class Dinic {
 public:
-    explicit Dinic(int N);
+    explicit Dinic(int N, std::pmr::memory_resource *mr = std::pmr::get_default_resource());
 
     void AddEdge(int u, int v, double cap);
 
@@ -37,12 +38,16 @@ public:
 
     std::vector<Edge> MinCut(int S, int T);
 
+    std::vector<std::vector<Edge>> EnumerateCuts(int S, int T, int max_cuts, double slack = 0);
+
 private:
     int N;
-    std::vector<Edge> E;
-    std::vector<std::vector<int>> G;
-    std::vector<int> level, pt;
-    std::vector<bool> res_visited;
+    std::pmr::vector<Edge> E;
+    std::pmr::vector<std::pmr::vector<int>> G;
+    std::pmr::vector<int> level, pt;
+    std::pmr::vector<bool> res_visited;
+    std::pmr::vector<int> touched;
+    std::pmr::vector<uint64_t> frontier, next_frontier;
 };
 
 #endif
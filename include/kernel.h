@@ -0,0 +1,86 @@
+/**
+ * @file kernel.h
+ * @brief
+ * @author Nathan Zhou
+ * @date 2019-02-24
+ * @bug No known bugs.
+ */
+
+#ifndef DALS_KERNEL_H
+#define DALS_KERNEL_H
+
+#include <cstdint>
+
+/* Kernels with the word count as a template parameter are fully unrolled and vectorized by the compiler,
+ * the ones taking n are the generic tails */
+
+template<int W>
+inline int PopXor(const uint64_t *__restrict a, const uint64_t *__restrict b) {
+    int cnt = 0;
+    for (int i = 0; i < W; i++)
+        cnt += __builtin_popcountll(a[i] ^ b[i]);
+    return cnt;
+}
+
+inline int PopXor(const uint64_t *__restrict a, const uint64_t *__restrict b, int n) {
+    int cnt = 0;
+    for (int i = 0; i < n; i++)
+        cnt += __builtin_popcountll(a[i] ^ b[i]);
+    return cnt;
+}
+
+template<int W>
+inline void SimAnd2(const uint64_t *__restrict a, const uint64_t *__restrict b, uint64_t a_mask, uint64_t b_mask,
+                    uint64_t out_mask, uint64_t *__restrict out) {
+    for (int i = 0; i < W; i++)
+        out[i] = ((a[i] ^ a_mask) & (b[i] ^ b_mask)) ^ out_mask;
+}
+
+inline void SimAnd2(const uint64_t *__restrict a, const uint64_t *__restrict b, uint64_t a_mask, uint64_t b_mask,
+                    uint64_t out_mask, uint64_t *__restrict out, int n) {
+    for (int i = 0; i < n; i++)
+        out[i] = ((a[i] ^ a_mask) & (b[i] ^ b_mask)) ^ out_mask;
+}
+
+template<int W>
+inline void OrXor(uint64_t *__restrict acc, const uint64_t *__restrict a, const uint64_t *__restrict b) {
+    for (int i = 0; i < W; i++)
+        acc[i] |= a[i] ^ b[i];
+}
+
+inline void OrXor(uint64_t *__restrict acc, const uint64_t *__restrict a, const uint64_t *__restrict b, int n) {
+    for (int i = 0; i < n; i++)
+        acc[i] |= a[i] ^ b[i];
+}
+
+/* In-place transpose of a 64x64 bit matrix, bit j of row i moves to bit i of row j */
+inline void Transpose64(uint64_t *a) {
+    uint64_t m = 0x00000000FFFFFFFFULL;
+    for (int j = 32; j != 0; j >>= 1, m ^= m << j)
+        for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            uint64_t t = ((a[k] >> j) ^ a[k | j]) & m;
+            a[k] ^= t << j;
+            a[k | j] ^= t;
+        }
+}
+
+/* Adds one bit per lane to 64 bit-sliced counters, planes[k] holds bit k of every lane's count */
+inline void VerticalAdd(uint64_t *planes, uint64_t x) {
+    for (int k = 0; x; k++) {
+        uint64_t carry = planes[k] & x;
+        planes[k] ^= x;
+        x = carry;
+    }
+}
+
+struct SimKernels {
+    int (*pop_xor)(const uint64_t *, const uint64_t *, int);
+
+    void (*sim_and2)(const uint64_t *, const uint64_t *, uint64_t, uint64_t, uint64_t, uint64_t *, int);
+
+    void (*or_xor)(uint64_t *, const uint64_t *, const uint64_t *, int);
+};
+
+SimKernels GetSimKernels(int n_words);
+
+#endif
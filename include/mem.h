@@ -0,0 +1,114 @@
+/**
+ * @file mem.h
+ * @brief
+ * @author Nathan Zhou
+ * @date 2019-02-25
+ * @bug No known bugs.
+ */
+
+#ifndef DALS_MEM_H
+#define DALS_MEM_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <memory_resource>
+#include <atomic>
+#include <abc_plus.h>
+
+using namespace abc_plus;
+
+/* Word buffer for large signature matrices, backed by huge pages where the platform has them
+ * and interleaved over the NUMA nodes */
+class PageBuffer {
+public:
+    PageBuffer();
+
+    PageBuffer(PageBuffer &&other) noexcept;
+
+    PageBuffer &operator=(PageBuffer &&other) noexcept;
+
+    PageBuffer(const PageBuffer &) = delete;
+
+    PageBuffer &operator=(const PageBuffer &) = delete;
+
+    ~PageBuffer();
+
+    // contents are zero, pages are only placed once they are first written
+    void Allocate(size_t n_words);
+
+    void Release();
+
+    uint64_t *Data() { return data_; }
+
+    const uint64_t *Data() const { return data_; }
+
+    size_t Size() const { return n_words_; }
+
+    bool IsHuge() const { return huge_; }
+
+    uint64_t &operator[](size_t i) { return data_[i]; }
+
+    const uint64_t &operator[](size_t i) const { return data_[i]; }
+
+private:
+    uint64_t *data_;
+    size_t n_words_;
+    size_t n_bytes_;
+    bool mapped_;
+    bool huge_;
+};
+
+/* Thread-safe pass-through resource that keeps the bytes currently taken from its upstream and their peak */
+class CountingResource : public std::pmr::memory_resource {
+public:
+    explicit CountingResource(std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
+
+    size_t GetBytes() const;
+
+    size_t GetPeakBytes() const;
+
+    void ResetPeak();
+
+private:
+    std::pmr::memory_resource *upstream_;
+    std::atomic<size_t> bytes_;
+    std::atomic<size_t> peak_bytes_;
+
+    void *do_allocate(size_t bytes, size_t alignment) override;
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+};
+
+template<typename T>
+size_t VectorBytes(const std::vector<T> &v) { return v.capacity() * sizeof(T); }
+
+// buckets plus one node per entry, a node holds the value and about two pointers
+template<typename Map>
+size_t HashMapBytes(const Map &m) {
+    return m.bucket_count() * sizeof(void *) + m.size() * (sizeof(typename Map::value_type) + 2 * sizeof(void *));
+}
+
+size_t NtkMemBytes(NtkPtr ntk);
+
+struct MemoryReport {
+    size_t signatures;
+    size_t candidates;
+    size_t alc_snapshots;
+    size_t opt_alcs;
+    size_t timing;
+    size_t flow;
+    size_t networks;
+    int sim_64_cycles;
+    int requested_sim_64_cycles;
+
+    MemoryReport();
+
+    size_t GetTotal() const;
+
+    void Print() const;
+};
+
+#endif
@@ -18,6 +18,8 @@ public:
 
     void ApproximateSubstitution(bool verbose = false);
 
+    bool ChainedSubstitution();
+
     void StaticTimingAnalysis();
 
     void Visualization();
@@ -28,6 +30,10 @@ public:
 
     void CriticalErrorNetwork();
 
+    void ParallelMaxFlow(int n_threads = 0);
+
+    bool DifferentialValidation();
+
     void operator=(Playground const &) = delete;
 
     Playground(Playground const &) = delete;
@@ -0,0 +1,29 @@
+/**
+ * @file prob.h
+ * @brief
+ * @author Nathan Zhou
+ * @date 2019-02-12
+ * @bug Signal probabilities assume independent fanins, so they are only approximate under reconvergence.
+ *      The prefilter built on them is therefore a heuristic, not a sound bound, and it is scoped to signal
+ *      probabilities only: candidates are ranked by their local disagreement, which observability does not change,
+ *      so no backward observability pass is computed.
+ */
+
+#ifndef DALS_PROB_H
+#define DALS_PROB_H
+
+#include <unordered_map>
+#include <abc_plus.h>
+
+using namespace abc_plus;
+
+struct ProbObject {
+    double probability;
+    explicit ProbObject(double probability);
+};
+
+std::unordered_map<ObjPtr, ProbObject> CalcSignalProb(NtkPtr ntk, bool print_result = false);
+
+double EstSubPairErrorLowerBound(const ProbObject &target, const ProbObject &substitute, bool allow_complement);
+
+#endif
@@ -0,0 +1,69 @@
+/**
+ * @file push_relabel.h
+ * @brief
+ * @author Nathan Zhou
+ * @date 2019-02-26
+ * @bug No known bugs.
+ */
+
+#ifndef DALS_PUSH_RELABEL_H
+#define DALS_PUSH_RELABEL_H
+
+#include <vector>
+#include <atomic>
+#include <memory_resource>
+#include <dinic.h>
+#include <thread_pool.h>
+
+enum class FlowSolver {
+    Dinic,
+    PushRelabel
+};
+
+/* Parallel push-relabel in synchronous rounds. Heights are frozen while the active vertices push, so an edge
+ * pair is only ever pushed on by its higher end and only the excesses need atomic updates. The flow is run to
+ * completion, excess that cannot reach the sink returns to the source, so the source side of the cut is the
+ * same as the one of Dinic::MinCut. */
+class PushRelabel {
+public:
+    // the rounds run sequentially without a pool
+    explicit PushRelabel(int N, ThreadPool *pool = nullptr,
+                         std::pmr::memory_resource *mr = std::pmr::get_default_resource());
+
+    void AddEdge(int u, int v, double cap);
+
+    // capacities are rounded up to 2^-quantum_bits of the total finite capacity, at most 52 - 8 bits
+    void SetQuantumBits(int quantum_bits = 40);
+
+    double MaxFlow(int S, int T);
+
+    std::vector<Edge> MinCut(int S, int T);
+
+    int GetRoundNum() const;
+
+private:
+    int N;
+    ThreadPool *pool;
+    int n_slots;
+    int n_rounds;
+    int quantum_bits;
+    double quantum;
+    std::pmr::vector<Edge> E;
+    std::pmr::vector<std::pmr::vector<int>> G;
+    std::pmr::vector<double> cap;
+    std::pmr::vector<int> height, new_height;
+    std::pmr::vector<std::atomic<double>> excess;
+    std::pmr::vector<std::atomic<int>> mark;
+    std::pmr::vector<uint64_t> visited, frontier;
+    std::pmr::vector<std::atomic<uint64_t>> next_frontier;
+
+    double Residual(int k) const;
+
+    void GlobalRelabel(int S, int T);
+
+    // grain in items, bitset words cover 64 vertices each
+    template<typename Func>
+    void ParallelRange(int n, Func func, int grain = 256);
+};
+
+#endif
@@ -0,0 +1,21 @@
+/**
+ * @file renumber.h
+ * @brief
+ * @author Nathan Zhou
+ * @date 2019-02-16
+ * @bug No known bugs.
+ */
+
+#ifndef DALS_RENUMBER_H
+#define DALS_RENUMBER_H
+
+#include <vector>
+#include <abc_plus.h>
+
+using namespace abc_plus;
+
+std::vector<ObjPtr> NtkDFSOrder(NtkPtr ntk);
+
+NtkPtr NtkRenumber(NtkPtr ntk);
+
+#endif
@@ -0,0 +1,145 @@
+/**
+ * @file signature.h
+ * @brief
+ * @author Nathan Zhou
+ * @date 2019-02-18
+ * @bug No known bugs.
+ */
+
+#ifndef DALS_SIGNATURE_H
+#define DALS_SIGNATURE_H
+
+#include <vector>
+#include <deque>
+#include <abc_plus.h>
+#include <mem.h>
+#include <thread_pool.h>
+#include <sim.h>
+
+using namespace abc_plus;
+
+static const int SIG_BLOCK_WORDS = 256;
+
+/* Counter-based pattern stream, word w of PI i is a SplitMix64 step of the substream keyed by (seed, i) */
+inline uint64_t PatternWord(uint64_t seed, int pi, int word) {
+    auto mix = [](uint64_t x) {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    };
+    const uint64_t gamma = 0x9e3779b97f4a7c15ULL;
+    return mix(mix(seed + gamma * ((uint64_t) pi + 1)) + gamma * ((uint64_t) word + 1));
+}
+
+enum class TruthVecMode {
+    Full,
+    OnDemand,
+    Streaming
+};
+
+class SigScratch {
+public:
+    uint64_t *Alloc(int n_words);
+
+    void Reset();
+
+    // rows recomputed since the last reset, only valid for the same word range
+    const uint64_t *Lookup(int id, int word_begin, int n_words) const;
+
+    void Memo(int id, int word_begin, int n_words, const uint64_t *words);
+
+    // fanin rows of the nodes being recomputed, one level per recursion depth, kept across calls like the buffers
+    std::vector<const uint64_t *> &PushFanins();
+
+    void PopFanins();
+
+private:
+    std::vector<std::vector<uint64_t>> buffers_;
+    size_t top_ = 0;
+    std::deque<std::vector<const uint64_t *>> fanins_;
+    size_t fanins_top_ = 0;
+    std::vector<const uint64_t *> memo_;
+    std::vector<int> memo_ids_;
+    int memo_begin_ = -1;
+    int memo_n_ = 0;
+
+    void ClearMemo();
+};
+
+class SignatureStore {
+public:
+    SignatureStore();
+
+    void Build(NtkPtr ntk, int n_words, uint64_t seed, TruthVecMode mode,
+               const std::vector<ObjPtr> &keep_nodes = std::vector<ObjPtr>(), bool show_progress_bar = false,
+               ThreadPool *pool = nullptr);
+
+    bool IsStored(ObjPtr obj) const;
+
+    int GetWordNum() const;
+
+    size_t GetStoredNum() const;
+
+    size_t GetMemBytes() const;
+
+    const uint64_t *Get(ObjPtr obj, int word_begin, int n_words, SigScratch &scratch) const;
+
+private:
+    int n_words_;
+    TruthVecMode mode_;
+    size_t n_stored_;
+    std::vector<int> row_;
+    PageBuffer data_;
+    SimKernels block_kernels_;
+    SimKernels tail_kernels_;
+    SimKernels any_kernels_;
+
+    const SimKernels &GetKernels(int n_words) const;
+};
+
+std::vector<uint64_t> SimPOTruthVec(NtkPtr ntk, int n_words, uint64_t seed);
+
+std::vector<std::vector<int>> GroupPOCones(NtkPtr ntk, int n_groups);
+
+ErrorReport SimConeErrorReport(NtkPtr ntk, const uint64_t *golden, int n_words, uint64_t seed,
+                               ThreadPool *pool = nullptr, int n_groups = 0);
+
+/* Handle of a pattern set, every simulation with the same handle sees the same patterns */
+struct PatternSet {
+    uint64_t seed;
+    int n_words;
+
+    explicit PatternSet(uint64_t seed = 0, int n_words = 0);
+
+    bool operator==(const PatternSet &other) const;
+};
+
+/* PO outputs of a reference network on a pattern set, simulated once and shared by all approximate variants */
+class GoldenCache {
+public:
+    GoldenCache();
+
+    void Build(NtkPtr ntk, const PatternSet &patterns);
+
+    bool IsBuilt(NtkPtr ntk, const PatternSet &patterns) const;
+
+    const PatternSet &GetPatterns() const;
+
+    int GetPONum() const;
+
+    const uint64_t *GetPOWords(int po) const;
+
+    size_t GetMemBytes() const;
+
+private:
+    PatternSet patterns_;
+    NtkPtr ntk_;
+    int n_pos_;
+    std::vector<uint64_t> po_truth_vec_;
+};
+
+ErrorReport SimGoldenErrorReport(NtkPtr approx_ntk, const GoldenCache &golden, ThreadPool *pool = nullptr);
+
+double SimGoldenER(NtkPtr approx_ntk, const GoldenCache &golden, ThreadPool *pool = nullptr);
+
+#endif
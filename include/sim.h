@@ -0,0 +1,46 @@
+/**
+ * @file sim.h
+ * @brief
+ * @author Nathan Zhou
+ * @date 2019-02-14
+ * @bug No known bugs.
+ */
+
+#ifndef DALS_SIM_H
+#define DALS_SIM_H
+
+#include <vector>
+#include <abc_plus.h>
+#include <kernel.h>
+
+using namespace abc_plus;
+
+struct ErrorReport {
+    long long n_patterns;
+    long long any_err_cnt;
+    std::vector<long long> po_err_cnt;
+    std::vector<long long> hamming_hist;
+
+    ErrorReport();
+
+    double GetErrorRate() const;
+
+    double GetPOErrorRate(int po) const;
+
+    double GetMeanHammingDistance() const;
+
+    void Print() const;
+};
+
+// kernels are the ones picked for n_words by the caller, AIG nodes go through its sim_and2
+void SimNode(ObjPtr node, const std::vector<const uint64_t *> &fanin_words, uint64_t *out, int n_words,
+             const SimKernels &kernels);
+
+inline uint64_t SimTruth2(unsigned truth, uint64_t x, uint64_t y) {
+    return ((truth & 1u) ? ~x & ~y : 0) | ((truth & 2u) ? x & ~y : 0) |
+           ((truth & 4u) ? ~x & y : 0) | ((truth & 8u) ? x & y : 0);
+}
+
+ErrorReport SimErrorReport(const uint64_t *golden, const uint64_t *approx, int n_pos, int n_words);
+
+#endif
@@ -12,6 +12,9 @@
 #include <unordered_map>
 #include <map>
 #include <set>
+#include <vector>
+#include <unordered_set>
+#include <memory_resource>
 #include <abc_plus.h>
 
 using namespace abc_plus;
@@ -39,6 +42,104 @@ std::unordered_map<ObjPtr, TimeObject> CalcSlack(NtkPtr ntk, bool print_result =
 
 std::vector<Path> GetKMostCriticalPaths(NtkPtr ntk, int k = -1, bool print_result = false);
 
-std::map<int, std::set<int>> GetCriticalGraph(NtkPtr ntk);
+using CriticalGraph = std::pmr::map<int, std::pmr::set<int>>;
+
+CriticalGraph GetCriticalGraph(NtkPtr ntk, std::pmr::memory_resource *mr = std::pmr::get_default_resource());
+
+/* Zero-slack objects and edges that entered or left the critical graph in the last update */
+struct CriticalGraphDelta {
+    std::vector<int> added_nodes;
+    std::vector<int> removed_nodes;
+    std::vector<std::pair<int, int>> added_edges;
+    std::vector<std::pair<int, int>> removed_edges;
+};
+
+/* Unit-delay timing and critical graph kept up to date across network edits. Arrival times are pushed forward
+ * through the fanout cones of the edited objects and the delays to the POs backward through their fanin cones,
+ * then only the edges around objects whose timing or criticality changed are checked again. */
+class CriticalGraphTracker {
+public:
+    CriticalGraphTracker();
+
+    void Reset(NtkPtr ntk);
+
+    void Clear();
+
+    // edited_ids are the objects that were created, deleted or got new fanins or fanouts,
+    // the scratch of the update comes from mr and is dead once it returns
+    const CriticalGraphDelta &Update(const std::vector<int> &edited_ids,
+                                     std::pmr::memory_resource *mr = std::pmr::get_default_resource());
+
+    bool IsTracking(NtkPtr ntk) const;
+
+    int GetMaxDelay() const;
+
+    int GetArrivalTime(int id) const;
+
+    bool IsCritical(int id) const;
+
+    TimeObject GetTimeObject(int id) const;
+
+    const CriticalGraph &GetCriticalGraph() const;
+
+    const CriticalGraphDelta &GetLastDelta() const;
+
+    size_t GetMemBytes() const;
+
+private:
+    NtkPtr ntk_;
+    int max_delay_;
+    std::vector<bool> alive_;
+    std::vector<bool> critical_;
+    std::vector<int> arrival_;
+    std::vector<int> to_sink_;
+    std::vector<std::vector<int>> fanins_;
+    std::map<int, std::unordered_set<int>> by_length_;
+    CriticalGraph graph_;
+    CriticalGraphDelta delta_;
+
+    void Resize(int n);
+
+    int CalcArrival(ObjPtr obj) const;
+
+    int CalcToSink(ObjPtr obj) const;
+
+    void SetTiming(int id, bool alive, int arrival, int to_sink);
+
+    void SetCritical(int id);
+
+    void CheckEdge(int u, int v);
+};
+
+/* The critical graph as flat node and edge arrays, kept in step with the tracker deltas so the flow networks of
+ * a round are filled without walking the whole critical graph again */
+class CriticalFlowGraph {
+public:
+    void Reset(NtkPtr ntk, const CriticalGraphTracker &tracker);
+
+    void Clear();
+
+    void Apply(const CriticalGraphDelta &delta);
+
+    const std::vector<int> &GetNodes() const;
+
+    const std::vector<std::pair<int, int>> &GetEdges() const;
+
+    size_t GetMemBytes() const;
+
+private:
+    std::vector<int> nodes_;
+    std::vector<int> node_pos_;
+    std::vector<std::pair<int, int>> edges_;
+    std::unordered_map<long long, int> edge_pos_;
+
+    void AddNode(int id);
+
+    void RemoveNode(int id);
+
+    void AddEdge(int u, int v);
+
+    void RemoveEdge(int u, int v);
+};
 
 #endif
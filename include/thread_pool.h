@@ -0,0 +1,112 @@
+/**
+ * @file thread_pool.h
+ * @brief
+ * @author Nathan Zhou
+ * @date 2019-02-27
+ * @bug No known bugs.
+ */
+
+#ifndef DALS_THREAD_POOL_H
+#define DALS_THREAD_POOL_H
+
+#include <algorithm>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+/* Persistent work-stealing pool. Every worker owns a deque, pops its own tasks from the back and steals from the
+ * front of the others. Threads outside the pool share one more deque and help while they wait, so every thread
+ * has a slot in [0, GetSlotNum()) to index its per-worker scratch with. */
+class ThreadPool {
+public:
+    // -1 uses one worker less than the hardware threads, the caller is the last one
+    explicit ThreadPool(int n_workers = -1);
+
+    ThreadPool(const ThreadPool &) = delete;
+
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    ~ThreadPool();
+
+    int GetWorkerNum() const;
+
+    int GetSlotNum() const;
+
+    int GetSlot() const;
+
+    void Submit(std::function<void()> task);
+
+    bool RunOne();
+
+    // func(begin, end, slot) on chunks of at most grain indices of [0, n)
+    template<typename Func>
+    void ParallelRange(int n, int grain, Func func);
+
+    // func(i, slot) for every i in [0, n)
+    template<typename Func>
+    void ParallelFor(int n, Func func);
+
+private:
+    struct TaskQueue {
+        std::mutex mtx;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    int n_workers_;
+    std::vector<std::unique_ptr<TaskQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::mutex sleep_mtx_;
+    std::condition_variable sleep_cv_;
+    std::atomic<int> n_queued_;
+    bool stop_;
+
+    bool Pop(int slot, std::function<void()> &task);
+
+    void WorkerLoop(int slot);
+};
+
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool &pool);
+
+    ~TaskGroup();
+
+    void Run(std::function<void()> task);
+
+    void Wait();
+
+private:
+    ThreadPool &pool_;
+    std::atomic<int> n_pending_;
+};
+
+template<typename Func>
+void ThreadPool::ParallelRange(int n, int grain, Func func) {
+    grain = std::max(grain, 1);
+    if (n_workers_ == 0 || n <= grain) {
+        if (n > 0)
+            func(0, n, GetSlot());
+        return;
+    }
+    TaskGroup group(*this);
+    for (int begin = 0; begin < n; begin += grain) {
+        int end = std::min(n, begin + grain);
+        group.Run([this, &func, begin, end]() { func(begin, end, GetSlot()); });
+    }
+    group.Wait();
+}
+
+template<typename Func>
+void ThreadPool::ParallelFor(int n, Func func) {
+    ParallelRange(n, 1, [&func](int begin, int end, int slot) {
+        for (int i = begin; i < end; i++)
+            func(i, slot);
+    });
+}
+
+#endif
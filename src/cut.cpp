@@ -0,0 +1,179 @@
+/**
+ * @file cut.cpp
+ * @brief
+ * @author Nathan Zhou
+ * @date 2019-02-14
+ * @bug No known bugs.
+ */
+
+#include <algorithm>
+#include <bitset>
+#include <cut.h>
+#include <sim.h>
+
+// cut functions are single words
+static const SimKernels cut_kernels = GetSimKernels(1);
+
+static const uint64_t truth_vars[CUT_SIZE_MAX] = {
+        0xAAAAAAAAAAAAAAAA, 0xCCCCCCCCCCCCCCCC, 0xF0F0F0F0F0F0F0F0,
+        0xFF00FF00FF00FF00, 0xFFFF0000FFFF0000, 0xFFFFFFFF00000000
+};
+
+static const uint64_t swap_masks[CUT_SIZE_MAX - 1][3] = {
+        {0x9999999999999999, 0x2222222222222222, 0x4444444444444444},
+        {0xC3C3C3C3C3C3C3C3, 0x0C0C0C0C0C0C0C0C, 0x3030303030303030},
+        {0xF00FF00FF00FF00F, 0x00F000F000F000F0, 0x0F000F000F000F00},
+        {0xFF0000FFFF0000FF, 0x0000FF000000FF00, 0x00FF000000FF0000},
+        {0xFFFF00000000FFFF, 0x00000000FFFF0000, 0x0000FFFF00000000}
+};
+
+uint64_t TruthVar(int i) { return truth_vars[i]; }
+
+uint64_t TruthMask(int n_vars) { return n_vars == CUT_SIZE_MAX ? ~(uint64_t) 0 : ((uint64_t) 1 << (1 << n_vars)) - 1; }
+
+/* Swaps adjacent variables v and v + 1. */
+static uint64_t TruthSwapAdjacent(uint64_t truth, int v) {
+    int shift = 1 << v;
+    return (truth & swap_masks[v][0]) | ((truth & swap_masks[v][1]) << shift) | ((truth & swap_masks[v][2]) >> shift);
+}
+
+/* Re-expresses a truth table over the sorted leaves as a truth table over the sorted superset new_leaves. */
+uint64_t TruthExpand(uint64_t truth, const int *leaves, int size, const int *new_leaves, int new_size) {
+    // replicate the truth table so that the missing variables are don't-cares
+    truth &= TruthMask(size);
+    for (int v = size; v < CUT_SIZE_MAX; v++)
+        truth |= truth << (1 << v);
+    int pos = new_size - 1;
+    for (int i = size - 1; i >= 0; i--) {
+        while (new_leaves[pos] != leaves[i]) pos--;
+        for (int v = i; v < pos; v++)
+            truth = TruthSwapAdjacent(truth, v);
+    }
+    return truth;
+}
+
+static uint64_t CutSign(int leaf) { return (uint64_t) 1 << (leaf % 64); }
+
+static bool CutDominates(const Cut &a, const Cut &b) {
+    if (a.size > b.size || (a.sign & b.sign) != a.sign)
+        return false;
+    for (int i = 0, j = 0; i < a.size; i++, j++) {
+        while (j < b.size && b.leaves[j] < a.leaves[i]) j++;
+        if (j == b.size || b.leaves[j] != a.leaves[i])
+            return false;
+    }
+    return true;
+}
+
+static bool CutMerge(const Cut &a, const Cut &b, Cut &merged, int cut_size) {
+    int i = 0, j = 0, k = 0;
+    while (i < a.size || j < b.size) {
+        if (k == cut_size)
+            return false;
+        if (j == b.size || (i < a.size && a.leaves[i] < b.leaves[j]))
+            merged.leaves[k++] = a.leaves[i++];
+        else if (i == a.size || b.leaves[j] < a.leaves[i])
+            merged.leaves[k++] = b.leaves[j++];
+        else {
+            merged.leaves[k++] = a.leaves[i++];
+            j++;
+        }
+    }
+    merged.size = k;
+    merged.sign = a.sign | b.sign;
+    merged.depth = std::max(a.depth, b.depth);
+    return true;
+}
+
+CutManager::CutManager(int cut_size, int cut_limit) : cut_size_(std::min(cut_size, CUT_SIZE_MAX)), cut_limit_(cut_limit) {}
+
+void CutManager::Enumerate(NtkPtr ntk) {
+    auto n_objs = (size_t) abc::Abc_NtkObjNumMax(ntk);
+    // the arena keeps its capacity across rounds, only the counters are reset
+    if (cuts_.size() < n_objs * cut_limit_)
+        cuts_.resize(n_objs * cut_limit_);
+    cut_num_.assign(n_objs, 0);
+    depth_.assign(n_objs, 0);
+
+    for (auto const &obj : NtkTopoSortPINode(ntk)) {
+        int id = ObjID(obj);
+        auto fan_ins = ObjFanins(obj);
+        if (ObjIsPI(obj))
+            depth_[id] = 1;
+        else
+            for (auto const &fan_in : fan_ins)
+                depth_[id] = std::max(depth_[id], depth_[ObjID(fan_in)] + 1);
+
+        Cut &trivial = cuts_[id * cut_limit_];
+        trivial.leaves[0] = id;
+        trivial.size = 1;
+        trivial.depth = depth_[id];
+        trivial.sign = CutSign(id);
+        trivial.truth = TruthVar(0);
+        cut_num_[id] = 1;
+
+        if (ObjIsPI(obj) || fan_ins.empty())
+            continue;
+        chosen_.assign(fan_ins.size(), nullptr);
+        Cut empty{};
+        empty.size = 0;
+        empty.depth = 0;
+        empty.sign = 0;
+        MergeCuts(obj, fan_ins, 0, empty);
+    }
+}
+
+int CutManager::GetCutNum(ObjPtr obj) const { return cut_num_.at(ObjID(obj)); }
+
+const Cut *CutManager::GetCuts(ObjPtr obj) const { return &cuts_[ObjID(obj) * cut_limit_]; }
+
+int CutManager::GetDepth(ObjPtr obj) const { return depth_.at(ObjID(obj)); }
+
+void CutManager::MergeCuts(ObjPtr node, const std::vector<ObjPtr> &fan_ins, int i, const Cut &partial) {
+    if (i == (int) fan_ins.size()) {
+        Cut cut = partial;
+        // compose the node function over the fanin cut functions
+        expanded_truths_.resize(fan_ins.size());
+        fanin_truths_.resize(fan_ins.size());
+        for (int k = 0; k < (int) fan_ins.size(); k++) {
+            expanded_truths_[k] = TruthExpand(chosen_[k]->truth, chosen_[k]->leaves, chosen_[k]->size,
+                                              cut.leaves, cut.size);
+            fanin_truths_[k] = &expanded_truths_[k];
+        }
+        SimNode(node, fanin_truths_, &cut.truth, 1, cut_kernels);
+        AddCut(node, cut);
+        return;
+    }
+    int fan_in = ObjID(fan_ins[i]);
+    for (int k = 0; k < cut_num_[fan_in]; k++) {
+        const Cut &fan_in_cut = cuts_[fan_in * cut_limit_ + k];
+        Cut merged{};
+        if (!CutMerge(partial, fan_in_cut, merged, cut_size_))
+            continue;
+        chosen_[i] = &fan_in_cut;
+        MergeCuts(node, fan_ins, i + 1, merged);
+    }
+}
+
+void CutManager::AddCut(ObjPtr node, const Cut &cut) {
+    int id = ObjID(node);
+    Cut *begin = &cuts_[id * cut_limit_ + 1];
+    Cut *end = &cuts_[id * cut_limit_ + cut_num_[id]];
+    for (Cut *c = begin; c != end; c++)
+        if (CutDominates(*c, cut))
+            return;
+    // drop the cuts dominated by the new one
+    end = std::remove_if(begin, end, [&cut](const Cut &c) { return CutDominates(cut, c); });
+    auto priority = [](const Cut &a, const Cut &b) {
+        return a.depth < b.depth || (a.depth == b.depth && a.size < b.size);
+    };
+    Cut *pos = std::upper_bound(begin, end, cut, priority);
+    if (end - begin == cut_limit_ - 1) {
+        if (pos == end)
+            return;
+        end--;
+    }
+    std::move_backward(pos, end, end + 1);
+    *pos = cut;
+    cut_num_[id] = (int) (end - begin) + 2;
+}
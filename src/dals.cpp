@@ -10,6 +10,10 @@
 #include <algorithm>
 #include <bitset>
 #include <iomanip>
+#include <queue>
+#include <tuple>
+#include <mutex>
+#include <numeric>
 
 // resolve conflict between cpu timers and original timers (deprecated) in boost library
 #define timer timer_deprecated
@@ -22,6 +26,8 @@
 #include <dals.h>
 #include <sta.h>
 #include <dinic.h>
+#include <sim.h>
+#include <renumber.h>
 
 /////////////////////////////////////////////////////////////////////////////
 /// Class ALC, Approximate Local Change
@@ -36,8 +42,17 @@ ObjPtr ALC::GetTarget() const { return target_; }
 
 ObjPtr ALC::GetSubstitute() const { return substitute_; }
 
+// the object that drives the former fanouts of the target after Do()
+ObjPtr ALC::GetReplacement() const { return IsLocalApprox() ? approx_ : is_complemented_ ? inv_ : substitute_; }
+
 bool ALC::IsComplemented() const { return is_complemented_; }
 
+bool ALC::IsLocalApprox() const { return !leaves_.empty(); }
+
+const std::vector<ObjPtr> &ALC::GetLeaves() const { return leaves_; }
+
+unsigned ALC::GetTruth() const { return truth_; }
+
 void ALC::SetError(double err) { error_ = err; }
 
 void ALC::SetTarget(ObjPtr t) { target_ = t; }
@@ -50,7 +65,14 @@ void ALC::SetComplemented(bool is_complemented) { is_complemented_ = is_compleme
 // ALC Methods
 //---------------------------------------------------------------------------
 void ALC::Do() {
-    if (is_complemented_) {
+    if (IsLocalApprox()) {
+        auto ntk = abc::Abc_ObjNtk(target_);
+        approx_ = abc::Abc_NtkCreateNode(ntk);
+        for (auto const &leaf : leaves_)
+            abc::Abc_ObjAddFanin(approx_, leaf);
+        approx_->pData = abc::Abc_SopCreateFromTruth((abc::Mem_Flex_t *) ntk->pManFunc, (int) leaves_.size(), &truth_);
+        ObjReplace(target_, approx_);
+    } else if (is_complemented_) {
         inv_ = ObjCreateInv(substitute_);
         ObjReplace(target_, inv_);
     } else
@@ -68,7 +90,9 @@ void ALC::Recover() {
 //    if (is_complemented_)
 //        ObjDelete(inv_);
 
-    if (is_complemented_)
+    if (IsLocalApprox())
+        ObjDelete(approx_);
+    else if (is_complemented_)
         ObjDelete(inv_);
     for (auto const &fan_out : target_fan_outs_) {
         abc::Abc_ObjRemoveFanins(fan_out);
@@ -91,7 +115,29 @@ ALC::ALC() = default;
 
 ALC::ALC(ObjPtr t, ObjPtr s, bool is_complemented, double error) : error_(error), is_complemented_(is_complemented),
                                                                    target_(t), substitute_(s), inv_(nullptr),
+                                                                   truth_(0), approx_(nullptr),
                                                                    target_fan_outs_(std::vector<ObjPtr>()) {
+    SaveTargetFanouts();
+}
+
+ALC::ALC(ObjPtr t, ObjPtr leaf_0, ObjPtr leaf_1, unsigned truth, double error) : error_(error), is_complemented_(false),
+                                                                                 target_(t), substitute_(nullptr),
+                                                                                 inv_(nullptr), leaves_({leaf_0, leaf_1}),
+                                                                                 truth_(truth), approx_(nullptr),
+                                                                                 target_fan_outs_(std::vector<ObjPtr>()) {
+    SaveTargetFanouts();
+}
+
+ALC::~ALC() = default;
+
+size_t ALC::GetMemBytes() const {
+    size_t bytes = VectorBytes(leaves_) + VectorBytes(target_fan_outs_) + HashMapBytes(target_fan_out_fan_ins_);
+    for (auto const &[fan_out, fan_ins] : target_fan_out_fan_ins_)
+        bytes += VectorBytes(fan_ins);
+    return bytes;
+}
+
+void ALC::SaveTargetFanouts() {
     for (auto const &fan_out : ObjFanouts(target_)) {
         target_fan_outs_.push_back(fan_out);
         for (auto const &fan_in : ObjFanins(fan_out))
@@ -99,8 +145,6 @@ ALC::ALC(ObjPtr t, ObjPtr s, bool is_complemented, double error) : error_(error)
     }
 }
 
-ALC::~ALC() = default;
-
 /////////////////////////////////////////////////////////////////////////////
 /// Singleton Class DALS, Delay-Driven Approximate Logic Synthesis
 /////////////////////////////////////////////////////////////////////////////
@@ -115,158 +159,282 @@ std::shared_ptr<DALS> DALS::GetDALS() {
 
 NtkPtr DALS::GetApproxNtk() { return approx_ntk_; }
 
-void DALS::SetTargetNtk(NtkPtr ntk) {
-    target_ntk_ = NtkDuplicate(ntk);
+const ErrorReport &DALS::GetErrorReport() const { return err_report_; }
+
+const MemoryReport &DALS::GetMemoryReport() const { return mem_report_; }
+
+const GoldenCache &DALS::GetGoldenCache() const { return golden_; }
+
+DALSSettings DALS::GetSettings() const {
+    return {requested_sim_64_cycles_, seed_, requested_truth_vec_mode_, prob_prefilter_, prob_prefilter_margin_,
+            n_partitions_, pool_words_, pool_finalists_, adaptive_verify_, adaptive_max_k_, adaptive_cluster_tol_,
+            local_approx_, cut_size_, cut_limit_, requested_transposed_sigs_, mem_budget_, n_threads_, flow_solver_,
+            flow_quantum_bits_, alt_cuts_, alt_cut_slack_, cut_strategy_};
+}
+
+void DALS::SetSettings(const DALSSettings &settings) {
+    SetSim64Cycles(settings.sim_64_cycles);
+    SetSeed(settings.seed);
+    SetTruthVecMode(settings.truth_vec_mode);
+    SetProbPrefilter(settings.prob_prefilter, settings.prob_prefilter_margin);
+    SetPartitions(settings.n_partitions);
+    SetPatternPool(settings.pool_words, settings.pool_finalists);
+    SetAdaptiveVerify(settings.adaptive_verify, settings.adaptive_max_k, settings.adaptive_cluster_tol);
+    SetLocalApprox(settings.local_approx, settings.cut_size, settings.cut_limit);
+    SetTransposedSigs(settings.transposed_sigs);
+    SetMemoryBudget(settings.mem_budget);
+    if (settings.n_threads != n_threads_)
+        SetThreads(settings.n_threads);
+    SetFlowSolver(settings.flow_solver, settings.flow_quantum_bits);
+    SetAltCuts(settings.alt_cuts, settings.alt_cut_slack);
+    SetCutStrategy(settings.cut_strategy);
+}
+
+void DALS::SetTargetNtk(NtkPtr ntk, bool renumber) {
+    if (target_ntk_) {
+        NtkDelete(target_ntk_);
+        NtkDelete(approx_ntk_);
+        // a new network may reuse the address of the old one
+        golden_ = GoldenCache();
+    }
+    // renumbering puts the fanins of a node next to it in every ID-indexed array
+    target_ntk_ = renumber ? NtkRenumber(ntk) : NtkDuplicate(ntk);
     approx_ntk_ = NtkDuplicate(target_ntk_);
+    timing_.Clear();
+    flow_graph_.Clear();
+}
+
+void DALS::SetSim64Cycles(int sim_64_cycles) {
+    sim_64_cycles_ = sim_64_cycles;
+    requested_sim_64_cycles_ = sim_64_cycles;
+}
+
+void DALS::SetProbPrefilter(bool enable, double margin) {
+    prob_prefilter_ = enable;
+    prob_prefilter_margin_ = margin;
+}
+
+void DALS::SetSeed(uint64_t seed) { seed_ = seed; }
+
+void DALS::SetTruthVecMode(TruthVecMode mode) {
+    truth_vec_mode_ = mode;
+    requested_truth_vec_mode_ = mode;
+}
+
+void DALS::SetPatternPool(int pool_words, int n_finalists) {
+    pool_words_ = pool_words;
+    pool_finalists_ = n_finalists;
 }
 
-void DALS::SetSim64Cycles(int sim_64_cycles) { sim_64_cycles_ = sim_64_cycles; }
+void DALS::SetAdaptiveVerify(bool enable, int max_k, double cluster_tol) {
+    adaptive_verify_ = enable;
+    adaptive_max_k_ = max_k;
+    adaptive_cluster_tol_ = cluster_tol;
+}
+
+void DALS::SetPartitions(int n_partitions) { n_partitions_ = n_partitions; }
+
+void DALS::SetLocalApprox(bool enable, int cut_size, int cut_limit) {
+    local_approx_ = enable;
+    cut_size_ = cut_size;
+    cut_limit_ = cut_limit;
+    cut_manager_ = CutManager(cut_size, cut_limit);
+}
+
+void DALS::SetTransposedSigs(bool enable) {
+    transposed_sigs_ = enable;
+    requested_transposed_sigs_ = enable;
+}
+
+void DALS::SetMemoryBudget(size_t bytes) { mem_budget_ = bytes; }
+
+void DALS::SetThreads(int n_threads) {
+    // the calling thread takes part in the parallel loops, 0 picks the hardware threads
+    n_threads_ = n_threads;
+    pool_.reset(new ThreadPool(n_threads - 1));
+    worker_scratch_ = std::vector<EvalScratch>(pool_->GetSlotNum());
+}
+
+void DALS::SetFlowSolver(FlowSolver solver, int quantum_bits) {
+    flow_solver_ = solver;
+    flow_quantum_bits_ = quantum_bits;
+}
+
+void DALS::SetAltCuts(int max_cuts, double slack) {
+    alt_cuts_ = max_cuts;
+    alt_cut_slack_ = slack;
+}
+
+void DALS::SetCutStrategy(CutStrategy strategy) { cut_strategy_ = strategy; }
 
 //---------------------------------------------------------------------------
 // DALS Methods
 //---------------------------------------------------------------------------
-void DALS::CalcTruthVec(bool show_progress_bar) { truth_vec_ = SimTruthVec(approx_ntk_, show_progress_bar, sim_64_cycles_); }
+void DALS::CalcTruthVec(bool show_progress_bar, const std::vector<ObjPtr> &keep_nodes) {
+    truth_vec_.Build(approx_ntk_, sim_64_cycles_, seed_, truth_vec_mode_, keep_nodes, show_progress_bar, pool_.get());
+}
 
 void DALS::CalcALCs(const std::vector<ObjPtr> &target_nodes, bool show_progress, int top_k) {
     cand_alcs_.clear();
 
     boost::timer::cpu_timer timer;
-    timer.start();
-    CalcTruthVec(show_progress);
-    if (show_progress)
-        std::cout << "Calc TruthVec Finished" << timer.format() << std::endl;
-
-    for (auto const &t_node : target_nodes)
-        cand_alcs_.emplace(t_node, std::vector<ALC>());
-    auto time_info = CalcSlack(approx_ntk_);
-    auto s_nodes = NtkTopoSortPINode(approx_ntk_);
+    PrepareALCs(target_nodes, show_progress);
 
     timer.start();
     // calculate candidate ALCs for each target node
     boost::progress_display *pd = nullptr;
-    if (show_progress) pd = new boost::progress_display(cand_alcs_.size());
-    for (auto const &t_node : target_nodes) {
-        if (show_progress) ++(*pd);
-        for (auto const &s_node : s_nodes)
-            if (t_node != s_node && time_info.at(s_node).arrival_time < time_info.at(t_node).arrival_time) {
-                double est_error = EstSubPairError(t_node, s_node);
-                if (time_info.at(s_node).arrival_time < time_info.at(t_node).arrival_time - 1)
-                    cand_alcs_[t_node].emplace_back(t_node, s_node, est_error > 0.5, std::min(est_error, 1 - est_error));
-                else
-                    cand_alcs_[t_node].emplace_back(t_node, s_node, false, est_error);
-            }
-        if (cand_alcs_[t_node].size() > top_k)
-            std::partial_sort(cand_alcs_[t_node].begin(), cand_alcs_[t_node].begin() + top_k, cand_alcs_[t_node].end(),
-                              [](const auto &a, const auto &b) {
-                                  return a.GetError() < b.GetError();
-                              });
-        else
-            std::sort(cand_alcs_[t_node].begin(), cand_alcs_[t_node].end(),
-                      [](const auto &a, const auto &b) {
-                          return a.GetError() < b.GetError();
-                      });
-    }
-    if (show_progress)
+    std::mutex pd_mtx;
+    auto tick = [&]() {
+        std::lock_guard<std::mutex> lock(pd_mtx);
+        ++(*pd);
+    };
+    if (show_progress) pd = new boost::progress_display(target_nodes.size());
+    int cand_k = adaptive_verify_ ? std::max(top_k, adaptive_max_k_) : top_k;
+    // the map is only filled here, its elements stay in place while the workers fill them
+    std::vector<std::vector<ALC> *> target_alcs;
+    for (auto const &t_node : target_nodes)
+        target_alcs.push_back(&cand_alcs_[t_node]);
+    std::vector<long long> n_pruned_of(pool_->GetSlotNum(), 0);
+    pool_->ParallelFor((int) target_nodes.size(), [&](int i, int slot) {
+        CalcCandALCs(target_nodes[i], cand_k, *target_alcs[i], worker_scratch_[slot].sig, n_pruned_of[slot]);
+        if (show_progress) tick();
+    });
+    for (auto const &alcs : target_alcs)
+        RecordDisagreements(*alcs);
+    long long n_pruned = std::accumulate(n_pruned_of.begin(), n_pruned_of.end(), 0LL);
+    if (show_progress) {
         std::cout << "Calc Candidate ALCs Finished" << timer.format() << std::endl;
+        if (prob_prefilter_)
+            std::cout << "Pruned by Signal Probability: " << n_pruned << std::endl;
+    }
 
     timer.start();
     // calculate the most optimal ALC for each target node
     if (show_progress) pd = new boost::progress_display(cand_alcs_.size());;
-    std::vector<ALC> k_alcs;
-    for (auto const &t_node : target_nodes) {
-        if (show_progress) ++(*pd);
-        k_alcs.clear();
-        for (auto alc: cand_alcs_[t_node]) {
-            if (k_alcs.size() == top_k) break;
-            alc.Do();
-            alc.SetError(SimER(target_ntk_, approx_ntk_));
-            alc.Recover();
-            k_alcs.push_back(alc);
-        }
-        std::sort(k_alcs.begin(), k_alcs.end(),
-                  [](const auto &a, const auto &b) {
-                      return a.GetError() < b.GetError();
-                  });
-        opt_alc_.emplace(t_node, k_alcs.front());
-    }
-    if (show_progress)
+    std::vector<ALC> opt_alcs(target_nodes.size());
+    std::vector<long long> n_verified_of(pool_->GetSlotNum(), 0);
+    pool_->ParallelFor((int) target_nodes.size(), [&](int i, int slot) {
+        if (show_progress) tick();
+        if (!target_alcs[i]->empty())
+            opt_alcs[i] = VerifyCandALCs(*target_alcs[i], top_k, worker_scratch_[slot], n_verified_of[slot]);
+    });
+    for (size_t i = 0; i < target_nodes.size(); i++)
+        if (!target_alcs[i]->empty())
+            opt_alc_.insert_or_assign(target_nodes[i], opt_alcs[i]);
+    long long n_verified = std::accumulate(n_verified_of.begin(), n_verified_of.end(), 0LL);
+    if (show_progress) {
         std::cout << "Calc Optimal ALC Finished" << timer.format() << std::endl;
+        std::cout << "Verified ALCs: " << n_verified << std::endl;
+    }
 }
 
-double DALS::EstSubPairError(ObjPtr target, ObjPtr substitute) {
-    int err_cnt = 0;
-    for (int i = 0; i < sim_64_cycles_; i++)
-        err_cnt += std::bitset<64>(truth_vec_.at(target)[i] ^ truth_vec_.at(substitute)[i]).count();
-    return (double) err_cnt / (double) (64 * sim_64_cycles_);
+const std::vector<ALC> &DALS::GetCandALCs(ObjPtr target) const { return cand_alcs_.at(target); }
+
+double DALS::EstSubPairError(ObjPtr target, ObjPtr substitute) { return EstSubPairError(target, substitute, sig_scratch_); }
+
+double DALS::EstLocalApproxError(ObjPtr target, ObjPtr leaf_0, ObjPtr leaf_1, unsigned truth) {
+    return EstLocalApproxError(target, leaf_0, leaf_1, truth, sig_scratch_);
+}
+
+double DALS::EvalALC(const ALC &alc) { return EvalALC(alc, eval_scratch_); }
+
+double DALS::EvalALCs(const std::vector<const ALC *> &alcs) {
+    return EvalALCs(alcs.data(), (int) alcs.size(), eval_scratch_);
+}
+
+/* ALCs with later targets go first, so a substitute that is itself a target is replaced after the ALCs reading it,
+ * their fanouts then follow it to its new function as in EvalALCs. The ALCs are left in the applied order,
+ * recover them in reverse. Returns the IDs of the edited objects */
+std::vector<int> DALS::DoALCs(std::vector<ALC *> &alcs) {
+    std::sort(alcs.begin(), alcs.end(), [this](const ALC *a, const ALC *b) {
+        int u = ObjID(a->GetTarget()), v = ObjID(b->GetTarget());
+        return std::make_pair(arrival_time_[u], topo_index_[u]) > std::make_pair(arrival_time_[v], topo_index_[v]);
+    });
+    std::vector<int> edited_ids;
+    for (auto const &alc : alcs) {
+        edited_ids.push_back(ObjID(alc->GetTarget()));
+        alc->Do();
+        edited_ids.push_back(ObjID(alc->GetReplacement()));
+        for (auto const &fan_out : ObjFanouts(alc->GetReplacement()))
+            edited_ids.push_back(ObjID(fan_out));
+    }
+    return edited_ids;
 }
 
 void DALS::Run(double err_constraint) {
+    // the critical nodes of the first round size the signatures under a budget
+    timing_.Reset(approx_ntk_);
+    ApplyMemoryBudget(3, true);
+    if (alt_cuts_ > 1 && flow_solver_ == FlowSolver::PushRelabel)
+        std::cout << "Warning: Alt Cuts enumerate the cuts with Dinic instead of Push Relabel" << std::endl;
+    golden_.Build(target_ntk_, PatternSet(seed_, sim_64_cycles_));
+    flow_graph_.Reset(approx_ntk_, timing_);
+    int target_delay = GetKMostCriticalPaths(target_ntk_, 1)[0].max_delay;
     double err = 0;
     int round = 0;
     while (err < err_constraint) {
         round++;
-        auto time_info = CalcSlack(approx_ntk_);
+        opt_alc_.clear();
+        // inverters, local approximations and new critical nodes grow the rows of every round, PrepareALCs
+        // follows a lowered pattern count with the golden outputs
+        if (round > 1)
+            ApplyMemoryBudget(3, false);
 
+        // critical objects in the order of their arrival times, which is a topological order
+        auto const &critical_nodes = flow_graph_.GetNodes();
+        std::pmr::vector<int> critical_ids(critical_nodes.begin(), critical_nodes.end(), &round_arena_);
+        std::sort(critical_ids.begin(), critical_ids.end(), [&](int a, int b) {
+            return std::make_pair(timing_.GetArrivalTime(a), a) < std::make_pair(timing_.GetArrivalTime(b), b);
+        });
         std::vector<ObjPtr> pis_nodes_0, nodes_0;
-        for (auto const &obj : NtkTopoSortPINode(approx_ntk_))
-            if (time_info.at(obj).slack == 0) {
-                pis_nodes_0.push_back(obj);
-                if (ObjIsNode(obj)) nodes_0.push_back(obj);
-            }
-
-        CalcALCs(nodes_0, false, 3);
-
-        int N = abc::Abc_NtkObjNumMax(approx_ntk_) + 1;
-        int source = 0, sink = N - 1;
-        Dinic dinic(N * 2);
-
-        for (const auto &obj_0 : pis_nodes_0) {
-            int u = ObjID(obj_0);
-            if (ObjIsPI(obj_0))
-                dinic.AddEdge(source, u, std::numeric_limits<double>::max());
-            else {
-                if (opt_alc_.at(obj_0).GetError() == 0)
-                    dinic.AddEdge(u, u + N, std::numeric_limits<double>::min());
-                else
-                    dinic.AddEdge(u, u + N, opt_alc_.at(obj_0).GetError());
-                if (ObjIsPONode(obj_0))
-                    dinic.AddEdge(u + N, sink, std::numeric_limits<double>::max());
-            }
+        for (auto const &id : critical_ids) {
+            pis_nodes_0.push_back(NtkObjbyID(approx_ntk_, id));
+            if (ObjIsNode(pis_nodes_0.back())) nodes_0.push_back(pis_nodes_0.back());
         }
 
-        for (auto &[u, vs] : GetCriticalGraph(approx_ntk_)) {
-            for (auto &v : vs) {
-                if (ObjIsPI(NtkObjbyID(approx_ntk_, u)))
-                    dinic.AddEdge(u, v, std::numeric_limits<double>::max());
-                else
-                    dinic.AddEdge(u + N, v, std::numeric_limits<double>::max());
-            }
-        }
-
-//        for (auto &[u, vs] : GetCriticalGraph(approx_ntk_)) {
-//            std::cout << u << ": ";
-//            for (auto &v : vs) std::cout << v << " ";
-//            std::cout << std::endl;
-//        }
+        std::vector<ObjPtr> cut_nodes;
+        if (cut_strategy_ == CutStrategy::Greedy)
+            cut_nodes = CalcGreedyCut(pis_nodes_0, nodes_0, 3);
+        else if (n_partitions_ > 1)
+            cut_nodes = CalcPartitionedCut(pis_nodes_0, nodes_0, 3);
+        else
+            cut_nodes = CalcMinCut(pis_nodes_0, nodes_0, 3);
 
         std::cout << "---------------------------------------------------------------------------" << std::endl;
         std::cout << "> Round " << round << std::endl;
         std::cout << "---------------------------------------------------------------------------" << std::endl;
         std::cout << "MinCut: " << std::endl;
-        for (const auto edge : dinic.MinCut(source, sink)) {
-            auto obj = NtkObjbyID(approx_ntk_, edge.u);
-            std::cout << ObjName(obj) << "--->" << ObjName(opt_alc_.at(obj).GetSubstitute())
-                      << " : " << opt_alc_.at(obj).IsComplemented()
+        std::vector<ALC *> alcs;
+        for (auto const &obj : cut_nodes) {
+            std::cout << ObjName(obj) << "--->";
+            if (opt_alc_.at(obj).IsLocalApprox())
+                std::cout << "f" << opt_alc_.at(obj).GetTruth() << "(" << ObjName(opt_alc_.at(obj).GetLeaves()[0])
+                          << "," << ObjName(opt_alc_.at(obj).GetLeaves()[1]) << ")";
+            else
+                std::cout << ObjName(opt_alc_.at(obj).GetSubstitute());
+            std::cout << " : " << opt_alc_.at(obj).IsComplemented()
                       << " : " << opt_alc_.at(obj).GetError()
                       << std::endl;
-            opt_alc_.at(obj).Do();
+            alcs.push_back(&opt_alc_.at(obj));
         }
+        auto const &delta = timing_.Update(DoALCs(alcs), &round_arena_);
+        flow_graph_.Apply(delta);
+        std::cout << "Critical Graph: +" << delta.added_edges.size() << " -" << delta.removed_edges.size()
+                  << " edges" << std::endl;
+
+        err_report_ = SimGoldenErrorReport(approx_ntk_, golden_, pool_.get());
+        err = err_report_.GetErrorRate();
+        err_report_.Print();
+        std::cout << "Delay: " << target_delay << "--->" << timing_.GetMaxDelay() << std::endl;
+
+        SampleMemory();
+        mem_report_.timing += timing_.GetMemBytes() + flow_graph_.GetMemBytes();
+        mem_report_.Print();
 
-        err = SimER(target_ntk_, approx_ntk_);
-        std::cout << "Error Rate: " << err << std::endl;
-        std::cout << "Delay: "
-                  << GetKMostCriticalPaths(target_ntk_, 1)[0].max_delay << "--->"
-                  << GetKMostCriticalPaths(approx_ntk_, 1)[0].max_delay << std::endl;
+        // flow networks and the timing update scratch of this round are gone, their memory goes back at once;
+        // the critical graph itself lives on in the tracker across rounds
+        round_arena_.release();
+        flow_mem_.ResetPeak();
 
 //        std::cout << "Do: " << ObjName(NtkObjbyID(approx_ntk_, 383)) << std::endl;
 //        opt_alc_.at(NtkObjbyID(approx_ntk_, 383)).Do();
@@ -331,8 +499,995 @@ void DALS::Run(double err_constraint) {
 // Operator Methods, Constructors & Destructors
 //---------------------------------------------------------------------------
 DALS::~DALS() {
-    NtkDelete(target_ntk_);
-    NtkDelete(approx_ntk_);
+    if (target_ntk_) {
+        NtkDelete(target_ntk_);
+        NtkDelete(approx_ntk_);
+    }
+}
+
+DALS::DALS() : target_ntk_(nullptr), approx_ntk_(nullptr), sim_64_cycles_(0), requested_sim_64_cycles_(0), seed_(0),
+               truth_vec_mode_(TruthVecMode::Full), requested_truth_vec_mode_(TruthVecMode::Full), block_kernels_(GetSimKernels(SIG_BLOCK_WORDS)),
+               tail_kernels_(GetSimKernels(0)), pool_kernels_(GetSimKernels(0)), round_arena_(&flow_mem_),
+               prob_prefilter_(false), prob_prefilter_margin_(0.05), local_approx_(false),
+               cut_size_(CUT_SIZE_MAX), cut_limit_(8),
+               n_partitions_(1), pool_words_(0), pool_finalists_(16),
+               adaptive_verify_(false), adaptive_max_k_(8), adaptive_cluster_tol_(0.005), transposed_sigs_(false),
+               requested_transposed_sigs_(false), mem_budget_(0), flow_solver_(FlowSolver::Dinic),
+               flow_quantum_bits_(40),
+               alt_cuts_(1), alt_cut_slack_(0), cut_strategy_(CutStrategy::MaxFlow) { SetThreads(); }
+
+void DALS::PrepareALCs(const std::vector<ObjPtr> &target_nodes, bool show_progress) {
+    boost::timer::cpu_timer timer;
+    timer.start();
+    CalcTruthVec(show_progress, target_nodes);
+    if (show_progress)
+        std::cout << "Calc TruthVec Finished" << timer.format() << std::endl;
+
+    s_nodes_ = NtkTopoSortPINode(approx_ntk_);
+    arrival_time_.assign(abc::Abc_NtkObjNumMax(approx_ntk_), 0);
+    // within Run the tracked timing is current, a full STA is only needed for standalone calls
+    if (timing_.IsTracking(approx_ntk_))
+        for (auto const &obj : s_nodes_)
+            arrival_time_[ObjID(obj)] = timing_.GetArrivalTime(ObjID(obj));
+    else
+        for (auto const &[obj, t_obj] : CalcSlack(approx_ntk_))
+            arrival_time_[ObjID(obj)] = t_obj.arrival_time;
+    topo_index_.assign(abc::Abc_NtkObjNumMax(approx_ntk_), -1);
+    for (int i = 0; i < (int) s_nodes_.size(); i++)
+        topo_index_[ObjID(s_nodes_[i])] = i;
+    po_drivers_.clear();
+    for (int i = 0; i < abc::Abc_NtkPoNum(approx_ntk_); i++)
+        po_drivers_.push_back(abc::Abc_ObjFanin0(abc::Abc_NtkPo(approx_ntk_, i)));
+
+    // kernels specialized on the block widths of this run
+    block_kernels_ = GetSimKernels(SIG_BLOCK_WORDS);
+    tail_kernels_ = GetSimKernels(sim_64_cycles_ % SIG_BLOCK_WORDS);
+    pool_kernels_ = GetSimKernels(pool_words_);
+
+    // current PO errors against the golden outputs, the base of every ALC evaluation
+    if (!golden_.IsBuilt(target_ntk_, PatternSet(seed_, sim_64_cycles_)))
+        golden_.Build(target_ntk_, PatternSet(seed_, sim_64_cycles_));
+    po_err_.resize(po_drivers_.size() * sim_64_cycles_);
+    err_any_.assign(sim_64_cycles_, 0);
+    base_err_cnt_ = 0;
+    for (int begin = 0; begin < sim_64_cycles_; begin += SIG_BLOCK_WORDS) {
+        int n = std::min(SIG_BLOCK_WORDS, sim_64_cycles_ - begin);
+        sig_scratch_.Reset();
+        for (int p = 0; p < (int) po_drivers_.size(); p++) {
+            auto approx = truth_vec_.Get(po_drivers_[p], begin, n, sig_scratch_);
+            for (int i = 0; i < n; i++) {
+                size_t w = (size_t) p * sim_64_cycles_ + begin + i;
+                po_err_[w] = approx[i] ^ golden_.GetPOWords(p)[begin + i];
+                err_any_[begin + i] |= po_err_[w];
+            }
+        }
+    }
+    for (auto const &word : err_any_)
+        base_err_cnt_ += std::bitset<64>(word).count();
+
+    // signal probabilities give an O(n) lower bound on the estimated error of each pair
+    prob_info_.clear();
+    if (prob_prefilter_)
+        prob_info_ = CalcSignalProb(approx_ntk_);
+
+    if (local_approx_) {
+        timer.start();
+        cut_manager_.Enumerate(approx_ntk_);
+        if (show_progress)
+            std::cout << "Enumerate Cuts Finished" << timer.format() << std::endl;
+    }
+
+    if (pool_words_ > 0) {
+        timer.start();
+        BuildPatternPool();
+        if (show_progress)
+            std::cout << "Build Pattern Pool Finished" << timer.format() << std::endl;
+    }
+
+    sub_order_.clear();
+    sub_sigs_t_.clear();
+    sub_err_begin_.clear();
+    sub_err_cnt_.clear();
+    if (transposed_sigs_ && pool_words_ == 0 && !prob_prefilter_) {
+        timer.start();
+        BuildTransposedSigs(target_nodes);
+        if (show_progress)
+            std::cout << "Build Transposed Signatures Finished" << timer.format() << std::endl;
+    }
+}
+
+void DALS::SampleMemory() {
+    mem_report_ = MemoryReport();
+    mem_report_.signatures = truth_vec_.GetMemBytes() + golden_.GetMemBytes() + VectorBytes(po_err_) +
+                             VectorBytes(err_any_) + VectorBytes(pool_truth_vec_) + VectorBytes(sub_sigs_t_) +
+                             VectorBytes(sub_err_begin_) + VectorBytes(sub_err_cnt_);
+    mem_report_.candidates = HashMapBytes(cand_alcs_);
+    for (auto const &[t_node, alcs] : cand_alcs_) {
+        mem_report_.candidates += VectorBytes(alcs);
+        for (auto const &alc : alcs)
+            mem_report_.alc_snapshots += alc.GetMemBytes();
+    }
+    mem_report_.opt_alcs = HashMapBytes(opt_alc_);
+    for (auto const &[t_node, alc] : opt_alc_)
+        mem_report_.alc_snapshots += alc.GetMemBytes();
+    mem_report_.timing = VectorBytes(arrival_time_) + VectorBytes(topo_index_) + VectorBytes(s_nodes_) +
+                         VectorBytes(po_drivers_) + HashMapBytes(prob_info_);
+    mem_report_.flow = flow_mem_.GetPeakBytes();
+    mem_report_.networks = NtkMemBytes(target_ntk_) + NtkMemBytes(approx_ntk_);
+    mem_report_.sim_64_cycles = sim_64_cycles_;
+    mem_report_.requested_sim_64_cycles = requested_sim_64_cycles_;
+}
+
+/* Picks the fastest storage mode that holds the patterns within the budget, then drops the transposed layout,
+ * and only then lowers the number of patterns. Settings are only ever downgraded from what was asked for, and
+ * overriding an explicit setting or lowering the patterns is reported */
+void DALS::ApplyMemoryBudget(int top_k, bool first_round) {
+    auto last = std::make_tuple(truth_vec_mode_, transposed_sigs_, sim_64_cycles_);
+    // every run starts from the requested settings, not from what an earlier budget left behind
+    truth_vec_mode_ = requested_truth_vec_mode_;
+    transposed_sigs_ = requested_transposed_sigs_;
+    if (requested_sim_64_cycles_ > 0)
+        sim_64_cycles_ = requested_sim_64_cycles_;
+    if (mem_budget_ == 0)
+        return;
+    auto objs = NtkTopoSortPINode(approx_ntk_);
+    size_t n_objs = objs.size(), n_pis = abc::Abc_NtkPiNum(approx_ntk_), n_pos = abc::Abc_NtkPoNum(approx_ntk_);
+    size_t n_nodes = n_objs - n_pis, n_targets = 0, n_on_demand = 0;
+    // the targets of a round are its critical nodes, OnDemand keeps their rows as well
+    bool tracking = timing_.IsTracking(approx_ntk_);
+    for (auto const &obj : objs) {
+        bool is_target = ObjIsNode(obj) && (!tracking || timing_.IsCritical(ObjID(obj)));
+        n_targets += is_target;
+        if (ObjIsPI(obj) || abc::Abc_ObjFanoutNum(obj) != 1 || ObjIsPONode(obj) || is_target)
+            n_on_demand++;
+    }
+
+    // networks, trimmed candidate lists with their snapshots, timing vectors and the pattern pool
+    int cand_k = adaptive_verify_ ? std::max(top_k, adaptive_max_k_) : top_k;
+    size_t fixed = NtkMemBytes(target_ntk_) + NtkMemBytes(approx_ntk_) +
+                   n_nodes * (cand_k * (sizeof(ALC) + 64) + 2 * sizeof(ALC)) + n_objs * 4 * sizeof(int) +
+                   n_objs * pool_words_ * sizeof(uint64_t);
+    size_t avail = mem_budget_ > fixed ? mem_budget_ - fixed : 0;
+    // bytes per 64 patterns: stored rows, golden outputs, PO errors, their union and the golden PI rows
+    auto word_bytes = [&](size_t n_rows) { return (n_rows + 3 * n_pos + n_pis + 1) * sizeof(uint64_t); };
+    // the transposed layout holds one block of every object and a counter per target and substitute
+    size_t transposed_bytes = ((n_objs + 63) / 64 * 64) * SIG_BLOCK_WORDS * sizeof(uint64_t) +
+                              n_targets * n_objs * sizeof(int) + n_objs * sizeof(long long);
+
+    const std::pair<TruthVecMode, size_t> modes[] = {{TruthVecMode::Full,      n_objs},
+                                                     {TruthVecMode::OnDemand,  n_on_demand},
+                                                     {TruthVecMode::Streaming, n_pis}};
+    bool fits = false;
+    for (bool transposed : {transposed_sigs_, false}) {
+        for (auto const &[mode, n_rows] : modes)
+            if (mode >= requested_truth_vec_mode_ &&
+                word_bytes(n_rows) * sim_64_cycles_ + (transposed ? transposed_bytes : 0) <= avail) {
+                truth_vec_mode_ = mode;
+                transposed_sigs_ = transposed;
+                fits = true;
+                break;
+            }
+        if (fits) break;
+    }
+    if (!fits) {
+        truth_vec_mode_ = TruthVecMode::Streaming;
+        transposed_sigs_ = false;
+        sim_64_cycles_ = (int) std::max((size_t) 1, avail / word_bytes(n_pis));
+    }
+
+    // later rounds only report a change
+    if (!first_round && std::make_tuple(truth_vec_mode_, transposed_sigs_, sim_64_cycles_) == last)
+        return;
+    static const char *mode_names[] = {"Full", "OnDemand", "Streaming"};
+    if (truth_vec_mode_ != requested_truth_vec_mode_)
+        std::cout << "Warning: Memory Budget overrides Truth Vec Mode " << mode_names[(int) requested_truth_vec_mode_]
+                  << " with " << mode_names[(int) truth_vec_mode_] << std::endl;
+    if (transposed_sigs_ != requested_transposed_sigs_)
+        std::cout << "Warning: Memory Budget disables Transposed Signatures" << std::endl;
+    if (sim_64_cycles_ < requested_sim_64_cycles_)
+        std::cout << "Warning: Memory Budget lowers Sim 64 Cycles from " << requested_sim_64_cycles_ << " to "
+                  << sim_64_cycles_ << std::endl;
+    std::cout << "Memory Budget: " << (double) mem_budget_ / (double) (1 << 20) << " MB"
+              << ", Truth Vec Mode: " << mode_names[(int) truth_vec_mode_]
+              << ", Sim 64 Cycles: " << sim_64_cycles_ << std::endl;
+}
+
+/* Equal errors are broken by the node IDs and the function, so the order never depends on the input order */
+static bool ALCBefore(const ALC &a, const ALC &b) {
+    auto key = [](const ALC &alc) {
+        auto id = [](ObjPtr obj) { return obj ? ObjID(obj) : -1; };
+        auto const &leaves = alc.GetLeaves();
+        return std::make_tuple(alc.GetError(), id(alc.GetTarget()), id(alc.GetSubstitute()), alc.IsComplemented(),
+                               alc.IsLocalApprox(), leaves.empty() ? -1 : id(leaves[0]),
+                               leaves.size() < 2 ? -1 : id(leaves[1]), alc.GetTruth());
+    };
+    return key(a) < key(b);
+}
+
+void DALS::CalcCandALCs(ObjPtr t_node, int top_k, std::vector<ALC> &cand_alcs, SigScratch &scratch,
+                        long long &n_pruned) const {
+    std::priority_queue<double> k_errors;
+    int t_arrival = arrival_time_[ObjID(t_node)];
+    // pool estimates are biased towards errors, so the probability bound does not apply to them
+    bool use_pool = pool_words_ > 0;
+    if (ObjID(t_node) < (int) sub_err_begin_.size() && sub_err_begin_[ObjID(t_node)] >= 0) {
+        // the mismatch counts against every eligible substitute were added up block by block
+        const int *err_cnt = &sub_err_cnt_[sub_err_begin_[ObjID(t_node)]];
+        for (int g = 0; g < GetSubGroupNum(t_node); g++) {
+            for (int l = 0; l < 64 && g * 64 + l < (int) sub_order_.size(); l++) {
+                auto s_node = sub_order_[g * 64 + l];
+                if (arrival_time_[ObjID(s_node)] >= t_arrival)
+                    break;
+                double est_error = (double) err_cnt[g * 64 + l] / (double) (64 * sim_64_cycles_);
+                if (arrival_time_[ObjID(s_node)] < t_arrival - 1)
+                    cand_alcs.emplace_back(t_node, s_node, est_error > 0.5, std::min(est_error, 1 - est_error));
+                else
+                    cand_alcs.emplace_back(t_node, s_node, false, est_error);
+            }
+        }
+    } else {
+        for (auto const &s_node : s_nodes_)
+            if (t_node != s_node && arrival_time_[ObjID(s_node)] < t_arrival) {
+                bool allow_complement = arrival_time_[ObjID(s_node)] < t_arrival - 1;
+                if (!use_pool && prob_prefilter_ && k_errors.size() == (size_t) top_k &&
+                    EstSubPairErrorLowerBound(prob_info_.at(t_node), prob_info_.at(s_node), allow_complement) >
+                    k_errors.top() + prob_prefilter_margin_) {
+                    n_pruned++;
+                    continue;
+                }
+                double est_error = use_pool ? EstSubPairErrorOnPool(t_node, s_node)
+                                            : EstSubPairError(t_node, s_node, scratch);
+                if (allow_complement)
+                    cand_alcs.emplace_back(t_node, s_node, est_error > 0.5, std::min(est_error, 1 - est_error));
+                else
+                    cand_alcs.emplace_back(t_node, s_node, false, est_error);
+                k_errors.push(cand_alcs.back().GetError());
+                if (k_errors.size() > (size_t) top_k)
+                    k_errors.pop();
+            }
+    }
+    if (use_pool && !cand_alcs.empty()) {
+        // only the finalists of the pool are scored on the full pattern set
+        int n_finalists = std::min(std::max(pool_finalists_, top_k), (int) cand_alcs.size());
+        std::partial_sort(cand_alcs.begin(), cand_alcs.begin() + n_finalists, cand_alcs.end(), ALCBefore);
+        cand_alcs.erase(cand_alcs.begin() + n_finalists, cand_alcs.end());
+        for (auto &alc : cand_alcs) {
+            auto s_node = alc.GetSubstitute();
+            double est_error = EstSubPairError(t_node, s_node, scratch);
+            if (arrival_time_[ObjID(s_node)] < t_arrival - 1)
+                alc = ALC(t_node, s_node, est_error > 0.5, std::min(est_error, 1 - est_error));
+            else
+                alc = ALC(t_node, s_node, false, est_error);
+        }
+    }
+    if (local_approx_)
+        CalcLocalApproxALCs(t_node, t_arrival, cand_alcs, scratch);
+    if (cand_alcs.size() > (size_t) top_k) {
+        std::partial_sort(cand_alcs.begin(), cand_alcs.begin() + top_k, cand_alcs.end(), ALCBefore);
+        // only the first k are ever verified, the tail is dropped under a memory budget
+        if (mem_budget_ > 0)
+            cand_alcs.erase(cand_alcs.begin() + top_k, cand_alcs.end());
+    } else
+        std::sort(cand_alcs.begin(), cand_alcs.end(), ALCBefore);
+}
+
+const SimKernels &DALS::GetKernels(int n_words) const {
+    return n_words == SIG_BLOCK_WORDS ? block_kernels_ : tail_kernels_;
+}
+
+double DALS::EstSubPairError(ObjPtr target, ObjPtr substitute, SigScratch &scratch) const {
+    int err_cnt = 0;
+    for (int begin = 0; begin < sim_64_cycles_; begin += SIG_BLOCK_WORDS) {
+        int n = std::min(SIG_BLOCK_WORDS, sim_64_cycles_ - begin);
+        scratch.Reset();
+        auto t = truth_vec_.Get(target, begin, n, scratch);
+        auto s = truth_vec_.Get(substitute, begin, n, scratch);
+        err_cnt += GetKernels(n).pop_xor(t, s, n);
+    }
+    return (double) err_cnt / (double) (64 * sim_64_cycles_);
+}
+
+double DALS::EstLocalApproxError(ObjPtr target, ObjPtr leaf_0, ObjPtr leaf_1, unsigned truth, SigScratch &scratch) const {
+    int err_cnt = 0;
+    for (int begin = 0; begin < sim_64_cycles_; begin += SIG_BLOCK_WORDS) {
+        int n = std::min(SIG_BLOCK_WORDS, sim_64_cycles_ - begin);
+        scratch.Reset();
+        auto t = truth_vec_.Get(target, begin, n, scratch);
+        auto x = truth_vec_.Get(leaf_0, begin, n, scratch);
+        auto y = truth_vec_.Get(leaf_1, begin, n, scratch);
+        for (int i = 0; i < n; i++)
+            err_cnt += std::bitset<64>(t[i] ^ SimTruth2(truth, x[i], y[i])).count();
+    }
+    return (double) err_cnt / (double) (64 * sim_64_cycles_);
+}
+
+double DALS::EstSubPairErrorOnPool(ObjPtr target, ObjPtr substitute) const {
+    auto t = &pool_truth_vec_[(size_t) ObjID(target) * pool_words_];
+    auto s = &pool_truth_vec_[(size_t) ObjID(substitute) * pool_words_];
+    int err_cnt = pool_kernels_.pop_xor(t, s, pool_words_);
+    return (double) err_cnt / (double) pool_patterns_.size();
+}
+
+/* Word j of column w of a group holds pattern bit j of word w of its 64 substitutes. Only one block of columns is
+ * alive at a time, every target adds its mismatches against the eligible groups before the next block replaces it */
+void DALS::BuildTransposedSigs(const std::vector<ObjPtr> &target_nodes) {
+    sub_order_ = s_nodes_;
+    std::stable_sort(sub_order_.begin(), sub_order_.end(),
+                     [&](ObjPtr a, ObjPtr b) { return arrival_time_[ObjID(a)] < arrival_time_[ObjID(b)]; });
+    auto n_groups = (int) (sub_order_.size() + 63) / 64;
+    sub_sigs_t_.assign((size_t) n_groups * SIG_BLOCK_WORDS * 64, 0);
+
+    std::vector<ObjPtr> targets;
+    sub_err_begin_.assign(abc::Abc_NtkObjNumMax(approx_ntk_), -1);
+    size_t n_counts = 0;
+    for (auto const &t_node : target_nodes)
+        if (sub_err_begin_[ObjID(t_node)] < 0) {
+            sub_err_begin_[ObjID(t_node)] = (long long) n_counts;
+            n_counts += (size_t) GetSubGroupNum(t_node) * 64;
+            targets.push_back(t_node);
+        }
+    sub_err_cnt_.assign(n_counts, 0);
+
+    for (int begin = 0; begin < sim_64_cycles_; begin += SIG_BLOCK_WORDS) {
+        int n = std::min(SIG_BLOCK_WORDS, sim_64_cycles_ - begin);
+        pool_->ParallelFor(n_groups, [&](int g, int slot) {
+            auto &scratch = worker_scratch_[slot].sig;
+            uint64_t block[64];
+            const uint64_t *rows[64];
+            int n_lanes = std::min(64, (int) sub_order_.size() - g * 64);
+            scratch.Reset();
+            for (int l = 0; l < n_lanes; l++)
+                rows[l] = truth_vec_.Get(sub_order_[g * 64 + l], begin, n, scratch);
+            for (int i = 0; i < n; i++) {
+                for (int l = 0; l < 64; l++)
+                    block[l] = l < n_lanes ? rows[l][i] : 0;
+                Transpose64(block);
+                std::copy_n(block, 64, &sub_sigs_t_[((size_t) g * SIG_BLOCK_WORDS + i) * 64]);
+            }
+        });
+        pool_->ParallelFor((int) targets.size(), [&](int k, int slot) {
+            auto &scratch = worker_scratch_[slot].sig;
+            scratch.Reset();
+            auto t = truth_vec_.Get(targets[k], begin, n, scratch);
+            int *err_cnt = &sub_err_cnt_[sub_err_begin_[ObjID(targets[k])]];
+            for (int g = 0; g < GetSubGroupNum(targets[k]); g++)
+                AddSubGroupErrors(t, g, n, err_cnt + g * 64);
+        });
+    }
 }
 
-DALS::DALS() = default;
+/* Substitutes are ordered by arrival time, so the eligible ones of a target form a prefix of whole groups */
+int DALS::GetSubGroupNum(ObjPtr target) const {
+    int g = 0;
+    while (g * 64 < (int) sub_order_.size() && arrival_time_[ObjID(sub_order_[g * 64])] < arrival_time_[ObjID(target)])
+        g++;
+    return g;
+}
+
+void DALS::AddSubGroupErrors(const uint64_t *target_words, int group, int n_words, int *err_cnt) const {
+    // a block has less than 2^16 words, so 16 counter planes never overflow within it
+    const int n_planes = 16;
+    uint64_t planes[n_planes] = {0};
+    auto group_sigs = &sub_sigs_t_[(size_t) group * SIG_BLOCK_WORDS * 64];
+    for (int i = 0; i < n_words; i++) {
+        auto col = group_sigs + (size_t) i * 64;
+        for (int j = 0; j < 64; j++)
+            VerticalAdd(planes, col[j] ^ (0 - ((target_words[i] >> j) & 1)));
+    }
+    for (int l = 0; l < 64; l++)
+        for (int k = 0; k < n_planes; k++)
+            err_cnt[l] += (int) ((planes[k] >> l) & 1) << k;
+}
+
+void DALS::BuildPatternPool() {
+    int n_patterns = 64 * sim_64_cycles_;
+    auto pool_size = (size_t) std::min(64 * pool_words_, n_patterns);
+    std::vector<bool> chosen(n_patterns, false);
+    pool_patterns_.clear();
+    auto add = [&](int pattern, size_t limit) {
+        if (!chosen[pattern] && pool_patterns_.size() < limit) {
+            chosen[pattern] = true;
+            pool_patterns_.push_back(pattern);
+        }
+    };
+
+    /* Counterexamples first, then the patterns that separated the best candidates last round,
+     * and a spread of plain random patterns for the rest */
+    for (int w = 0; w < sim_64_cycles_ && pool_patterns_.size() < pool_size / 2; w++)
+        for (uint64_t word = err_any_[w]; word; word &= word - 1)
+            add(64 * w + __builtin_ctzll(word), pool_size / 2);
+    for (auto const &pattern : informative_patterns_)
+        if (pattern < n_patterns)
+            add(pattern, pool_size * 3 / 4);
+    const long long stride = 1000003;
+    for (long long i = 0; i < n_patterns && pool_patterns_.size() < pool_size; i++)
+        add((int) (i * stride % n_patterns), pool_size);
+    std::sort(pool_patterns_.begin(), pool_patterns_.end());
+    informative_patterns_.clear();
+
+    /* Gather the pool bits of every signature into compact rows */
+    pool_truth_vec_.assign((size_t) abc::Abc_NtkObjNumMax(approx_ntk_) * pool_words_, 0);
+    for (auto const &obj : s_nodes_) {
+        uint64_t *row = &pool_truth_vec_[(size_t) ObjID(obj) * pool_words_];
+        size_t j = 0;
+        for (int begin = 0; begin < sim_64_cycles_ && j < pool_patterns_.size(); begin += SIG_BLOCK_WORDS) {
+            int n = std::min(SIG_BLOCK_WORDS, sim_64_cycles_ - begin);
+            sig_scratch_.Reset();
+            auto words = truth_vec_.Get(obj, begin, n, sig_scratch_);
+            for (; j < pool_patterns_.size() && pool_patterns_[j] < 64 * (begin + n); j++) {
+                int pattern = pool_patterns_[j] - 64 * begin;
+                if ((words[pattern / 64] >> (pattern % 64)) & 1)
+                    row[j / 64] |= (uint64_t) 1 << (j % 64);
+            }
+        }
+    }
+}
+
+void DALS::RecordDisagreements(const std::vector<ALC> &cand_alcs) {
+    static const int n_patterns_per_target = 4;
+    if (pool_words_ == 0 || cand_alcs.size() < 2 || cand_alcs[0].IsLocalApprox() || cand_alcs[1].IsLocalApprox())
+        return;
+    uint64_t mask = cand_alcs[0].IsComplemented() != cand_alcs[1].IsComplemented() ? ~(uint64_t) 0 : 0;
+    int n_recorded = 0;
+    for (int begin = 0; begin < sim_64_cycles_ && n_recorded < n_patterns_per_target; begin += SIG_BLOCK_WORDS) {
+        int n = std::min(SIG_BLOCK_WORDS, sim_64_cycles_ - begin);
+        sig_scratch_.Reset();
+        auto a = truth_vec_.Get(cand_alcs[0].GetSubstitute(), begin, n, sig_scratch_);
+        auto b = truth_vec_.Get(cand_alcs[1].GetSubstitute(), begin, n, sig_scratch_);
+        for (int i = 0; i < n && n_recorded < n_patterns_per_target; i++)
+            if (uint64_t diff = a[i] ^ b[i] ^ mask) {
+                informative_patterns_.push_back(64 * (begin + i) + __builtin_ctzll(diff));
+                n_recorded++;
+            }
+    }
+}
+
+double DALS::EvalALC(const ALC &alc, EvalScratch &scratch) const {
+    const ALC *alcs[] = {&alc};
+    return EvalALCs(alcs, 1, scratch);
+}
+
+/* The targets of all ALCs are forced to their new functions, the rest of the network is resimulated from them */
+double DALS::EvalALCs(const ALC *const *alcs, int n_alcs, EvalScratch &scratch) const {
+    if (scratch.slot.size() < topo_index_.size())
+        scratch.slot.resize(topo_index_.size(), -1);
+    if (scratch.forced.size() < topo_index_.size())
+        scratch.forced.resize(topo_index_.size(), nullptr);
+    for (int a = 0; a < n_alcs; a++)
+        scratch.forced[ObjID(alcs[a]->GetTarget())] = alcs[a];
+    scratch.tmp.resize(SIG_BLOCK_WORDS);
+    scratch.err_mask.resize(SIG_BLOCK_WORDS);
+    // every substitute arrives before its target, so the arrival order stays topological after the ALCs
+    auto later = [this](ObjPtr a, ObjPtr b) {
+        return std::make_pair(arrival_time_[ObjID(a)], topo_index_[ObjID(a)]) >
+               std::make_pair(arrival_time_[ObjID(b)], topo_index_[ObjID(b)]);
+    };
+
+    /* Differences are propagated in level order and stop at every node whose signature is unchanged,
+     * the error only changes at the patterns where some PO differs */
+    long long err_cnt = base_err_cnt_;
+    for (int begin = 0; begin < sim_64_cycles_; begin += SIG_BLOCK_WORDS) {
+        int n = std::min(SIG_BLOCK_WORDS, sim_64_cycles_ - begin);
+        scratch.sig.Reset();
+        scratch.rows.clear();
+        scratch.touched.clear();
+        auto row = [&](ObjPtr obj) -> const uint64_t * {
+            int slot = scratch.slot[ObjID(obj)];
+            return slot >= 0 ? &scratch.rows[slot * SIG_BLOCK_WORDS] : truth_vec_.Get(obj, begin, n, scratch.sig);
+        };
+        auto commit = [&](ObjPtr obj, const uint64_t *words) {
+            auto old_words = truth_vec_.Get(obj, begin, n, scratch.sig);
+            uint64_t diff = 0;
+            for (int i = 0; i < n; i++)
+                diff |= words[i] ^ old_words[i];
+            if (diff == 0)
+                return;
+            scratch.slot[ObjID(obj)] = (int) (scratch.rows.size() / SIG_BLOCK_WORDS);
+            scratch.rows.insert(scratch.rows.end(), words, words + n);
+            scratch.rows.resize(scratch.rows.size() + SIG_BLOCK_WORDS - n);
+            for (auto const &fan_out : ObjFanouts(obj))
+                if (!ObjIsPO(fan_out) && scratch.slot[ObjID(fan_out)] == -1) {
+                    scratch.slot[ObjID(fan_out)] = -2;
+                    scratch.touched.push_back(fan_out);
+                    scratch.events.push_back(fan_out);
+                    std::push_heap(scratch.events.begin(), scratch.events.end(), later);
+                }
+        };
+
+        for (int a = 0; a < n_alcs; a++) {
+            auto target = alcs[a]->GetTarget();
+            if (scratch.slot[ObjID(target)] != -1)
+                continue;
+            scratch.slot[ObjID(target)] = -2;
+            scratch.touched.push_back(target);
+            scratch.events.push_back(target);
+            std::push_heap(scratch.events.begin(), scratch.events.end(), later);
+        }
+        uint64_t *t = scratch.tmp.data();
+        while (!scratch.events.empty()) {
+            std::pop_heap(scratch.events.begin(), scratch.events.end(), later);
+            ObjPtr node = scratch.events.back();
+            scratch.events.pop_back();
+            if (auto alc = scratch.forced[ObjID(node)]) {
+                if (alc->IsLocalApprox()) {
+                    auto x = row(alc->GetLeaves()[0]);
+                    auto y = row(alc->GetLeaves()[1]);
+                    for (int i = 0; i < n; i++)
+                        t[i] = SimTruth2(alc->GetTruth(), x[i], y[i]);
+                } else {
+                    auto s = row(alc->GetSubstitute());
+                    uint64_t mask = alc->IsComplemented() ? ~(uint64_t) 0 : 0;
+                    for (int i = 0; i < n; i++)
+                        t[i] = s[i] ^ mask;
+                }
+            } else {
+                scratch.fanin_words.clear();
+                for (int i = 0; i < abc::Abc_ObjFaninNum(node); i++)
+                    scratch.fanin_words.push_back(row(abc::Abc_ObjFanin(node, i)));
+                SimNode(node, scratch.fanin_words, t, n, GetKernels(n));
+            }
+            commit(node, t);
+        }
+
+        /* Patterns where an affected PO differs from before */
+        std::fill_n(scratch.err_mask.begin(), n, 0);
+        bool affected = false;
+        for (int p = 0; p < (int) po_drivers_.size(); p++)
+            if (scratch.slot[ObjID(po_drivers_[p])] >= 0) {
+                affected = true;
+                auto approx = row(po_drivers_[p]);
+                auto old_approx = truth_vec_.Get(po_drivers_[p], begin, n, scratch.sig);
+                GetKernels(n).or_xor(scratch.err_mask.data(), approx, old_approx, n);
+            }
+        for (int i = 0; affected && i < n; i++) {
+            uint64_t changed = scratch.err_mask[i];
+            if (changed == 0)
+                continue;
+            uint64_t err = 0;
+            for (int p = 0; p < (int) po_drivers_.size(); p++) {
+                uint64_t po_err = po_err_[(size_t) p * sim_64_cycles_ + begin + i];
+                if (scratch.slot[ObjID(po_drivers_[p])] >= 0)
+                    po_err ^= row(po_drivers_[p])[i] ^ truth_vec_.Get(po_drivers_[p], begin, n, scratch.sig)[i];
+                err |= po_err;
+            }
+            err_cnt += (long long) std::bitset<64>(err & changed).count() -
+                       (long long) std::bitset<64>(err_any_[begin + i] & changed).count();
+        }
+
+        for (auto const &obj : scratch.touched)
+            scratch.slot[ObjID(obj)] = -1;
+    }
+    for (int a = 0; a < n_alcs; a++)
+        scratch.forced[ObjID(alcs[a]->GetTarget())] = nullptr;
+    return (double) err_cnt / (double) (64 * sim_64_cycles_);
+}
+
+ALC DALS::VerifyCandALCs(const std::vector<ALC> &cand_alcs, int top_k, EvalScratch &scratch,
+                         long long &n_verified) const {
+    if (!adaptive_verify_) {
+        ALC best = cand_alcs.front();
+        best.SetError(EvalALC(best, scratch));
+        n_verified++;
+        for (int i = 1; i < std::min(top_k, (int) cand_alcs.size()); i++) {
+            ALC alc = cand_alcs[i];
+            alc.SetError(EvalALC(alc, scratch));
+            n_verified++;
+            if (alc.GetError() < best.GetError())
+                best = alc;
+        }
+        return best;
+    }
+
+    /* An ALC only changes the patterns where the target changes, so the estimated mismatch bounds the new
+     * error rate from below by the current error minus the estimate. Candidates whose bound is not below the
+     * best verified error are skipped, and k is widened while the estimates stay clustered around the k-th. */
+    double cur_err = (double) base_err_cnt_ / (double) (64 * sim_64_cycles_);
+    int k_limit = std::min(top_k, (int) cand_alcs.size());
+    double kth_est = cand_alcs[k_limit - 1].GetError();
+    int max_k = std::min(std::max(top_k, adaptive_max_k_), (int) cand_alcs.size());
+    while (k_limit < max_k && cand_alcs[k_limit].GetError() <= kth_est + adaptive_cluster_tol_)
+        k_limit++;
+
+    ALC best = cand_alcs.front();
+    best.SetError(EvalALC(best, scratch));
+    n_verified++;
+    for (int i = 1; i < k_limit; i++) {
+        if (best.GetError() <= cur_err - cand_alcs[i].GetError())
+            continue;
+        ALC alc = cand_alcs[i];
+        alc.SetError(EvalALC(alc, scratch));
+        n_verified++;
+        if (alc.GetError() < best.GetError())
+            best = alc;
+    }
+    return best;
+}
+
+std::vector<ObjPtr> DALS::CalcPartitionedCut(const std::vector<ObjPtr> &pis_nodes_0, const std::vector<ObjPtr> &nodes_0,
+                                             int top_k) {
+    // signatures and PO errors stay global, so every region measures its ALCs at the POs
+    PrepareALCs(nodes_0, false);
+    cand_alcs_.clear();
+
+    /* Every critical path visits every level once until it ends at a PO, so level bands split the critical graph
+     * into regions, and the cuts of all regions together cut the whole critical graph */
+    if (nodes_0.empty())
+        return std::vector<ObjPtr>();
+    int max_level = 0;
+    for (auto const &obj : nodes_0)
+        max_level = std::max(max_level, arrival_time_[ObjID(obj)]);
+    // nodes start at level 2, level 1 only holds the PIs
+    int n_regions = std::min(n_partitions_, max_level - 1);
+    int band = (max_level - 1 + n_regions - 1) / n_regions;
+    auto region_of = [&](int id) { return (arrival_time_[id] - 2) / band; };
+    std::vector<std::vector<ObjPtr>> region_nodes(n_regions);
+    for (auto const &obj : nodes_0)
+        region_nodes[region_of(ObjID(obj))].push_back(obj);
+
+    /* Candidate search and verification of every region on its own worker */
+    for (auto const &t_node : nodes_0)
+        cand_alcs_[t_node];
+    int cand_k = adaptive_verify_ ? std::max(top_k, adaptive_max_k_) : top_k;
+    std::vector<std::vector<ALC>> region_alcs(n_regions);
+    pool_->ParallelFor(n_regions, [&](int r, int slot) {
+        long long n_pruned = 0, n_verified = 0;
+        for (auto const &t_node : region_nodes[r]) {
+            auto &cand_alcs = cand_alcs_.at(t_node);
+            CalcCandALCs(t_node, cand_k, cand_alcs, worker_scratch_[slot].sig, n_pruned);
+            if (!cand_alcs.empty())
+                region_alcs[r].push_back(VerifyCandALCs(cand_alcs, top_k, worker_scratch_[slot], n_verified));
+        }
+    });
+    for (auto const &t_node : nodes_0)
+        RecordDisagreements(cand_alcs_.at(t_node));
+    for (auto const &alcs : region_alcs)
+        for (auto const &alc : alcs)
+            opt_alc_.insert_or_assign(alc.GetTarget(), alc);
+
+    /* Local min cuts of every region between its first and last level, on a network of the region alone.
+     * Their nodes are the candidates of the merge */
+    auto const &critical_graph = timing_.GetCriticalGraph();
+    int N = abc::Abc_NtkObjNumMax(approx_ntk_) + 1;
+    std::vector<int> index(N, -1);
+    std::vector<ObjPtr> merge_nodes;
+    auto capacity = [&](ObjPtr obj) {
+        double err = opt_alc_.at(obj).GetError();
+        return err == 0 ? std::numeric_limits<double>::min() : err;
+    };
+    for (int r = 0; r < n_regions; r++) {
+        auto const &nodes = region_nodes[r];
+        if (nodes.empty())
+            continue;
+        for (int k = 0; k < (int) nodes.size(); k++)
+            index[ObjID(nodes[k])] = k + 1;
+        int M = (int) nodes.size() + 2, sink = M - 1;
+        int lo = 2 + r * band, hi = std::min(1 + (r + 1) * band, max_level);
+        std::pmr::vector<Edge> edges(&round_arena_);
+        for (auto const &obj : nodes) {
+            int u = index[ObjID(obj)];
+            edges.emplace_back(u, u + M, capacity(obj));
+            if (arrival_time_[ObjID(obj)] == lo)
+                edges.emplace_back(0, u, std::numeric_limits<double>::max());
+            // critical POs below hi end their paths inside the region
+            if (arrival_time_[ObjID(obj)] == hi || ObjIsPONode(obj))
+                edges.emplace_back(u + M, sink, std::numeric_limits<double>::max());
+            auto it = critical_graph.find(ObjID(obj));
+            if (it != critical_graph.end())
+                for (auto const &v : it->second)
+                    if (index[v] > 0 && region_of(v) == r)
+                        edges.emplace_back(u + M, index[v], std::numeric_limits<double>::max());
+        }
+        for (auto const &cut : SolveMinCuts(M, edges))
+            for (auto const &edge : cut)
+                if (edge.cap != std::numeric_limits<double>::max())
+                    merge_nodes.push_back(nodes[edge.u - 1]);
+        for (auto const &obj : nodes)
+            index[ObjID(obj)] = -1;
+    }
+    std::sort(merge_nodes.begin(), merge_nodes.end(), [](ObjPtr a, ObjPtr b) { return ObjID(a) < ObjID(b); });
+    merge_nodes.erase(std::unique(merge_nodes.begin(), merge_nodes.end()), merge_nodes.end());
+
+    /* Summary graph of the candidates, where one leads to another if a critical path joins them past no other
+     * candidate. Its min cut may take the nodes of different regions on different paths, so it is never worse
+     * than the best single region cut */
+    for (int k = 0; k < (int) merge_nodes.size(); k++)
+        index[ObjID(merge_nodes[k])] = k + 1;
+    int M = (int) merge_nodes.size() + 2, sink = M - 1;
+    std::pmr::vector<Edge> edges(&round_arena_);
+    std::pmr::vector<int> visited(N, -1, &round_arena_), linked(M, -1, &round_arena_);
+    std::pmr::vector<int> stack(&round_arena_);
+    // start 0 walks from the critical PIs, start k from the k-th candidate
+    auto walk = [&](int start, const std::vector<int> &roots) {
+        int from = start == 0 ? 0 : start + M;
+        stack.assign(roots.begin(), roots.end());
+        while (!stack.empty()) {
+            int u = stack.back();
+            stack.pop_back();
+            auto it = critical_graph.find(u);
+            if (it == critical_graph.end())
+                continue;
+            for (auto const &v : it->second) {
+                if (index[v] > 0) {
+                    if (linked[index[v]] != start) {
+                        linked[index[v]] = start;
+                        edges.emplace_back(from, index[v], std::numeric_limits<double>::max());
+                    }
+                } else if (visited[v] != start) {
+                    visited[v] = start;
+                    if (ObjIsPONode(NtkObjbyID(approx_ntk_, v)) && linked[sink] != start) {
+                        linked[sink] = start;
+                        edges.emplace_back(from, sink, std::numeric_limits<double>::max());
+                    }
+                    stack.push_back(v);
+                }
+            }
+        }
+    };
+    std::vector<int> roots;
+    for (auto const &obj : pis_nodes_0)
+        if (ObjIsPI(obj))
+            roots.push_back(ObjID(obj));
+    walk(0, roots);
+    for (int k = 1; k <= (int) merge_nodes.size(); k++) {
+        auto obj = merge_nodes[k - 1];
+        edges.emplace_back(k, k + M, capacity(obj));
+        if (ObjIsPONode(obj))
+            edges.emplace_back(k + M, sink, std::numeric_limits<double>::max());
+        walk(k, std::vector<int>(1, ObjID(obj)));
+    }
+    for (auto const &obj : merge_nodes)
+        index[ObjID(obj)] = -1;
+
+    auto cuts = SolveMinCuts(M, edges);
+    for (auto &cut : cuts)
+        for (auto &edge : cut)
+            if (edge.cap != std::numeric_limits<double>::max())
+                edge.u = ObjID(merge_nodes[edge.u - 1]);
+    if (alt_cuts_ > 1)
+        return PickBestCut(cuts);
+    std::vector<ObjPtr> cut_nodes;
+    for (auto const &edge : cuts[0])
+        cut_nodes.push_back(NtkObjbyID(approx_ntk_, edge.u));
+    return cut_nodes;
+}
+
+/* Cuts of (nearly) the same capacity differ in the error of their ALCs applied together */
+std::vector<ObjPtr> DALS::PickBestCut(const std::vector<std::vector<Edge>> &cuts) {
+    std::vector<ObjPtr> best_nodes;
+    double best_err = std::numeric_limits<double>::max();
+    std::vector<const ALC *> alcs;
+    for (auto const &cut : cuts) {
+        alcs.clear();
+        std::vector<ObjPtr> cut_nodes;
+        for (auto const &edge : cut) {
+            if (edge.cap == std::numeric_limits<double>::max())
+                break;
+            cut_nodes.push_back(NtkObjbyID(approx_ntk_, edge.u));
+            alcs.push_back(&opt_alc_.at(cut_nodes.back()));
+        }
+        if (cut_nodes.size() != cut.size())
+            continue;
+        double err = EvalALCs(alcs.data(), (int) alcs.size(), eval_scratch_);
+        if (err < best_err) {
+            best_err = err;
+            best_nodes = cut_nodes;
+        }
+    }
+    std::cout << "Alternative Cuts: " << cuts.size() << ", Best Error: " << best_err << std::endl;
+    return best_nodes;
+}
+
+std::vector<ObjPtr> DALS::CalcMinCut(const std::vector<ObjPtr> &pis_nodes_0, const std::vector<ObjPtr> &nodes_0, int top_k) {
+    CalcALCs(nodes_0, false, top_k);
+
+    int N = abc::Abc_NtkObjNumMax(approx_ntk_) + 1;
+    int source = 0, sink = N - 1;
+    std::pmr::vector<Edge> edges(&round_arena_);
+
+    for (const auto &obj_0 : pis_nodes_0) {
+        int u = ObjID(obj_0);
+        if (ObjIsPI(obj_0))
+            edges.emplace_back(source, u, std::numeric_limits<double>::max());
+        else {
+            if (opt_alc_.at(obj_0).GetError() == 0)
+                edges.emplace_back(u, u + N, std::numeric_limits<double>::min());
+            else
+                edges.emplace_back(u, u + N, opt_alc_.at(obj_0).GetError());
+            if (ObjIsPONode(obj_0))
+                edges.emplace_back(u + N, sink, std::numeric_limits<double>::max());
+        }
+    }
+
+    for (auto const &[u, v] : flow_graph_.GetEdges()) {
+        if (ObjIsPI(NtkObjbyID(approx_ntk_, u)))
+            edges.emplace_back(u, v, std::numeric_limits<double>::max());
+        else
+            edges.emplace_back(u + N, v, std::numeric_limits<double>::max());
+    }
+
+    auto cuts = SolveMinCuts(N, edges);
+    if (alt_cuts_ > 1)
+        return PickBestCut(cuts);
+    std::vector<ObjPtr> cut_nodes;
+    for (auto const &edge : cuts[0])
+        cut_nodes.push_back(NtkObjbyID(approx_ntk_, edge.u));
+    return cut_nodes;
+}
+
+/* Node u of the network is split into u and u + N, the source is 0 and the sink N - 1. Returns the min cut of
+ * the chosen solver, or the alternative cuts of nearly the same capacity for PickBestCut */
+std::vector<std::vector<Edge>> DALS::SolveMinCuts(int N, const std::pmr::vector<Edge> &edges) {
+    int source = 0, sink = N - 1;
+    if (alt_cuts_ > 1) {
+        Dinic dinic(N * 2, &round_arena_);
+        for (auto const &edge : edges)
+            dinic.AddEdge(edge.u, edge.v, edge.cap);
+        return dinic.EnumerateCuts(source, sink, alt_cuts_, alt_cut_slack_);
+    }
+
+    if (flow_solver_ == FlowSolver::PushRelabel) {
+        PushRelabel push_relabel(N * 2, pool_.get(), &round_arena_);
+        push_relabel.SetQuantumBits(flow_quantum_bits_);
+        for (auto const &edge : edges)
+            push_relabel.AddEdge(edge.u, edge.v, edge.cap);
+        return {push_relabel.MinCut(source, sink)};
+    }
+    Dinic dinic(N * 2, &round_arena_);
+    for (auto const &edge : edges)
+        dinic.AddEdge(edge.u, edge.v, edge.cap);
+    return {dinic.MinCut(source, sink)};
+}
+
+/* Cuts the critical paths without a flow network: the node with the least error per critical path through it
+ * is taken until no path is left, path counts come from a forward and a backward pass over the critical graph.
+ * A removal only changes the counts from the PIs in its fanout cone and the counts to the POs in its fanin cone,
+ * so only these are updated. Nodes made redundant by later picks are dropped at the end. */
+std::vector<ObjPtr> DALS::CalcGreedyCut(const std::vector<ObjPtr> &pis_nodes_0, const std::vector<ObjPtr> &nodes_0,
+                                        int top_k) {
+    CalcALCs(nodes_0, false, top_k);
+
+    int N = abc::Abc_NtkObjNumMax(approx_ntk_);
+    std::pmr::vector<std::pmr::vector<int>> preds(N, &round_arena_), succs(N, &round_arena_);
+    for (auto const &[u, v] : flow_graph_.GetEdges()) {
+        preds[v].push_back(u);
+        succs[u].push_back(v);
+    }
+    std::vector<ObjPtr> order(pis_nodes_0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](ObjPtr a, ObjPtr b) { return arrival_time_[ObjID(a)] < arrival_time_[ObjID(b)]; });
+    std::pmr::vector<int> pos(N, 0, &round_arena_), pi_ids(&round_arena_);
+    for (int i = 0; i < (int) order.size(); i++) {
+        pos[ObjID(order[i])] = i;
+        if (ObjIsPI(order[i]))
+            pi_ids.push_back(ObjID(order[i]));
+    }
+
+    std::pmr::vector<double> from(N, 0, &round_arena_), to(N, 0, &round_arena_);
+    std::pmr::vector<bool> removed(N, false, &round_arena_);
+    auto calc_from = [&](int v) {
+        if (removed[v])
+            return 0.0;
+        double n_paths = ObjIsPI(order[pos[v]]) ? 1 : 0;
+        for (int u : preds[v])
+            n_paths += from[u];
+        return n_paths;
+    };
+    auto calc_to = [&](int v) {
+        if (removed[v])
+            return 0.0;
+        double n_paths = ObjIsPONode(order[pos[v]]) ? 1 : 0;
+        for (int w : succs[v])
+            n_paths += to[w];
+        return n_paths;
+    };
+    // paths left, summed over the critical PIs rather than carried along so that it reaches exactly 0
+    auto count_total = [&]() {
+        double total = 0;
+        for (int u : pi_ids)
+            total += to[u];
+        return total;
+    };
+    for (auto const &obj : order)
+        from[ObjID(obj)] = calc_from(ObjID(obj));
+    for (auto it = order.rbegin(); it != order.rend(); ++it)
+        to[ObjID(*it)] = calc_to(ObjID(*it));
+    double total = count_total();
+
+    /* Cones of a changed node over the edges, in topological order, not entering removed nodes */
+    std::pmr::vector<int> seen(N, -1, &round_arena_), cone(&round_arena_), stack(&round_arena_);
+    int stamp = 0;
+    auto collect_cone = [&](int x, const std::pmr::vector<std::pmr::vector<int>> &edges) {
+        stamp++;
+        seen[x] = stamp;
+        cone.assign(1, x);
+        stack.assign(1, x);
+        while (!stack.empty()) {
+            int u = stack.back();
+            stack.pop_back();
+            for (int w : edges[u])
+                if (seen[w] != stamp && !removed[w]) {
+                    seen[w] = stamp;
+                    cone.push_back(w);
+                    stack.push_back(w);
+                }
+        }
+        std::sort(cone.begin(), cone.end(), [&](int a, int b) { return pos[a] < pos[b]; });
+    };
+    auto update_cones = [&](int x) {
+        collect_cone(x, succs);
+        for (int v : cone)
+            from[v] = calc_from(v);
+        collect_cone(x, preds);
+        for (auto it = cone.rbegin(); it != cone.rend(); ++it)
+            to[*it] = calc_to(*it);
+        total = count_total();
+    };
+
+    std::vector<ObjPtr> cut_nodes;
+    while (total > 0) {
+        ObjPtr best = nullptr;
+        double best_score = std::numeric_limits<double>::max();
+        for (auto const &obj : nodes_0) {
+            double n_paths = from[ObjID(obj)] * to[ObjID(obj)];
+            if (n_paths == 0 || !opt_alc_.count(obj))
+                continue;
+            double score = opt_alc_.at(obj).GetError() / n_paths;
+            if (score < best_score) {
+                best_score = score;
+                best = obj;
+            }
+        }
+        if (best == nullptr)
+            break;
+        removed[ObjID(best)] = true;
+        update_cones(ObjID(best));
+        cut_nodes.push_back(best);
+    }
+
+    // with the other picks in place, every path left after restoring a pick passes through it
+    for (int i = (int) cut_nodes.size() - 1; i >= 0; i--) {
+        int x = ObjID(cut_nodes[i]);
+        removed[x] = false;
+        if (calc_from(x) * calc_to(x) > 0) {
+            removed[x] = true;
+            continue;
+        }
+        update_cones(x);
+        cut_nodes.erase(cut_nodes.begin() + i);
+    }
+    return cut_nodes;
+}
+
+void DALS::CalcLocalApproxALCs(ObjPtr t_node, int arrival_time, std::vector<ALC> &cand_alcs,
+                               SigScratch &scratch) const {
+    // two-input functions that cost the same as an AIG node: AND with any input and output polarity
+    static const unsigned and_truths[] = {1, 2, 4, 8, 7, 11, 13, 14};
+    std::vector<std::tuple<int, int, unsigned>> proposed;
+    auto cuts = cut_manager_.GetCuts(t_node);
+    // cuts are sorted by depth after the trivial cut, the new node has to arrive before the target
+    for (int c = 1; c < cut_manager_.GetCutNum(t_node) && cuts[c].depth < arrival_time - 1; c++) {
+        const Cut &cut = cuts[c];
+        uint64_t mask = TruthMask(cut.size);
+        for (int i = 0; i < cut.size; i++)
+            for (int j = i + 1; j < cut.size; j++) {
+                unsigned best_truth = 0;
+                int best_dist = 65;
+                for (unsigned truth : and_truths) {
+                    uint64_t approx = SimTruth2(truth, TruthVar(i), TruthVar(j));
+                    int dist = (int) std::bitset<64>((cut.truth ^ approx) & mask).count();
+                    if (dist < best_dist) {
+                        best_dist = dist;
+                        best_truth = truth;
+                    }
+                }
+                auto key = std::make_tuple(cut.leaves[i], cut.leaves[j], best_truth);
+                if (std::find(proposed.begin(), proposed.end(), key) != proposed.end())
+                    continue;
+                proposed.push_back(key);
+                auto leaf_0 = NtkObjbyID(approx_ntk_, cut.leaves[i]);
+                auto leaf_1 = NtkObjbyID(approx_ntk_, cut.leaves[j]);
+                cand_alcs.emplace_back(t_node, leaf_0, leaf_1, best_truth,
+                                       EstLocalApproxError(t_node, leaf_0, leaf_1, best_truth, scratch));
+            }
+    }
+}
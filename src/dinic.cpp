@@ -6,9 +6,14 @@
  * @bug No known bugs.
  */
 
+#include <algorithm>
+#include <queue>
+#include <set>
 #include <dinic.h>
 
-Dinic::Dinic(int N) : N(N), G(N, std::vector<int>()), level(N, 0), pt(N, 0), res_visited(N, false) {}
+Dinic::Dinic(int N, std::pmr::memory_resource *mr) : N(N), E(mr), G(N, mr), level(N, N + 1, mr), pt(N, 0, mr),
+                                                     res_visited(N, false, mr), touched(mr), frontier(mr),
+                                                     next_frontier(mr) {}
 
 void Dinic::AddEdge(int u, int v, double cap) {
     if (u != v) {
@@ -19,21 +24,62 @@ void Dinic::AddEdge(int u, int v, double cap) {
     }
 }
 
+/* Level-synchronous BFS on bitset frontiers. Wide levels are expanded bottom-up, where every unvisited vertex
+ * looks for a parent in the frontier among its incoming residual edges, the twins of its own edges. */
 bool Dinic::BFS(int S, int T) {
-    std::queue<int> q({S});
-    fill(level.begin(), level.end(), N + 1);
+    for (int v : touched)
+        level[v] = N + 1;
+    touched.clear();
+    int n_words = (N + 63) / 64;
+    frontier.assign(n_words, 0);
+    next_frontier.resize(n_words);
+
     level[S] = 0;
-    while (!q.empty()) {
-        int u = q.front();
-        q.pop();
-        if (u == T) break;
-        for (int k : G[u]) {
-            Edge &e = E[k];
-            if (e.flow < e.cap && level[e.v] > level[e.u] + 1) {
-                level[e.v] = level[e.u] + 1;
-                q.emplace(e.v);
+    touched.push_back(S);
+    frontier[S >> 6] |= (uint64_t) 1 << (S & 63);
+    long long n_frontier = 1, m_frontier = G[S].size(), m_unvisited = (long long) E.size() - m_frontier;
+    bool bottom_up = false;
+    for (int d = 0; n_frontier > 0 && level[T] == N + 1; d++) {
+        if (!bottom_up && m_frontier * 14 > m_unvisited)
+            bottom_up = true;
+        else if (bottom_up && n_frontier * 24 < N)
+            bottom_up = false;
+
+        std::fill(next_frontier.begin(), next_frontier.end(), 0);
+        long long n_next = 0, m_next = 0;
+        auto visit = [&](int v) {
+            level[v] = d + 1;
+            touched.push_back(v);
+            next_frontier[v >> 6] |= (uint64_t) 1 << (v & 63);
+            n_next++;
+            m_next += G[v].size();
+        };
+        if (bottom_up) {
+            for (int v = 0; v < N; v++) {
+                if (level[v] != N + 1) continue;
+                for (int k : G[v]) {
+                    Edge &e = E[k ^ 1];
+                    if (e.flow < e.cap && (frontier[e.u >> 6] >> (e.u & 63) & 1)) {
+                        visit(v);
+                        break;
+                    }
+                }
             }
+        } else {
+            for (int w = 0; w < n_words; w++)
+                for (uint64_t bits = frontier[w]; bits; bits &= bits - 1) {
+                    int u = w * 64 + __builtin_ctzll(bits);
+                    for (int k : G[u]) {
+                        Edge &e = E[k];
+                        if (e.flow < e.cap && level[e.v] == N + 1)
+                            visit(e.v);
+                    }
+                }
         }
+        m_unvisited -= m_next;
+        frontier.swap(next_frontier);
+        n_frontier = n_next;
+        m_frontier = m_next;
     }
     return level[T] != N + 1;
 }
@@ -88,3 +134,120 @@ std::vector<Edge> Dinic::MinCut(int S, int T) {
             min_cut.push_back(e);
     return min_cut;
 }
+
+/* The capacity of a cut is the max flow plus the residual capacity leaving its source side. Closed source sides,
+ * the minimal one plus the residual closure of any strongly connected component that does not reach the sink,
+ * are the other minimum cuts. Adding a component without its closure gives the near-minimum ones. */
+std::vector<std::vector<Edge>> Dinic::EnumerateCuts(int S, int T, int max_cuts, double slack) {
+    MaxFlow(S, T);
+    auto residual = [&](int k) { return E[k].flow < E[k].cap; };
+    fill(res_visited.begin(), res_visited.end(), false);
+    DFSResidualNetwork(S);
+    std::vector<bool> to_sink(N, false);
+    std::queue<int> q({T});
+    to_sink[T] = true;
+    while (!q.empty()) {
+        int v = q.front();
+        q.pop();
+        for (int k : G[v])
+            if (!to_sink[E[k].v] && residual(k ^ 1)) {
+                to_sink[E[k].v] = true;
+                q.push(E[k].v);
+            }
+    }
+    auto is_free = [&](int v) { return !res_visited[v] && !to_sink[v]; };
+
+    /* Tarjan's SCCs of the free vertices, emitted sinks first */
+    std::vector<std::vector<int>> comps;
+    std::vector<int> index(N, -1), low(N, 0), stack;
+    std::vector<bool> on_stack(N, false);
+    std::vector<std::pair<int, int>> calls;
+    int counter = 0;
+    auto open = [&](int v) {
+        index[v] = low[v] = counter++;
+        stack.push_back(v);
+        on_stack[v] = true;
+        calls.emplace_back(v, 0);
+    };
+    for (int s = 0; s < N; s++) {
+        if (!is_free(s) || index[s] != -1) continue;
+        open(s);
+        while (!calls.empty()) {
+            int u = calls.back().first;
+            if (calls.back().second < (int) G[u].size()) {
+                int k = G[u][calls.back().second++];
+                int v = E[k].v;
+                if (!residual(k) || !is_free(v)) continue;
+                if (index[v] == -1)
+                    open(v);
+                else if (on_stack[v])
+                    low[u] = std::min(low[u], index[v]);
+                continue;
+            }
+            calls.pop_back();
+            if (!calls.empty())
+                low[calls.back().first] = std::min(low[calls.back().first], low[u]);
+            if (low[u] == index[u]) {
+                comps.emplace_back();
+                int v;
+                do {
+                    v = stack.back();
+                    stack.pop_back();
+                    on_stack[v] = false;
+                    comps.back().push_back(v);
+                } while (v != u);
+            }
+        }
+    }
+
+    std::vector<std::pair<double, std::vector<int>>> cuts;
+    std::set<std::vector<int>> seen;
+    auto add_cut = [&](const std::vector<bool> &side) {
+        std::vector<int> edges;
+        double cap = 0;
+        for (int k = 0; k < (int) E.size(); k++)
+            if (E[k].cap > 0 && side[E[k].u] && !side[E[k].v]) {
+                edges.push_back(k);
+                cap += E[k].cap;
+            }
+        if (seen.insert(edges).second)
+            cuts.emplace_back(cap, edges);
+    };
+    std::vector<bool> side(res_visited.begin(), res_visited.end());
+    add_cut(side);
+    std::vector<int> dfs;
+    for (auto const &comp : comps) {
+        if ((int) cuts.size() >= 4 * max_cuts) break;
+        auto closure = side;
+        for (int v : comp) {
+            closure[v] = true;
+            dfs.push_back(v);
+        }
+        while (!dfs.empty()) {
+            int u = dfs.back();
+            dfs.pop_back();
+            for (int k : G[u])
+                if (!closure[E[k].v] && residual(k)) {
+                    closure[E[k].v] = true;
+                    dfs.push_back(E[k].v);
+                }
+        }
+        add_cut(closure);
+        if (slack > 0) {
+            auto near = side;
+            for (int v : comp)
+                near[v] = true;
+            add_cut(near);
+        }
+    }
+
+    std::stable_sort(cuts.begin(), cuts.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+    std::vector<std::vector<Edge>> result;
+    for (auto const &[cap, edges] : cuts) {
+        if ((int) result.size() == max_cuts || cap > cuts.front().first + slack) break;
+        result.emplace_back();
+        for (int k : edges)
+            result.back().push_back(E[k]);
+    }
+    return result;
+}
@@ -0,0 +1,44 @@
+/**
+ * @file kernel.cpp
+ * @brief
+ * @author Nathan Zhou
+ * @date 2019-02-24
+ * @bug No known bugs.
+ */
+
+#include <kernel.h>
+
+template<int W>
+static int PopXorFixed(const uint64_t *a, const uint64_t *b, int) { return PopXor<W>(a, b); }
+
+static int PopXorAny(const uint64_t *a, const uint64_t *b, int n) { return PopXor(a, b, n); }
+
+template<int W>
+static void SimAnd2Fixed(const uint64_t *a, const uint64_t *b, uint64_t a_mask, uint64_t b_mask, uint64_t out_mask,
+                         uint64_t *out, int) { SimAnd2<W>(a, b, a_mask, b_mask, out_mask, out); }
+
+static void SimAnd2Any(const uint64_t *a, const uint64_t *b, uint64_t a_mask, uint64_t b_mask, uint64_t out_mask,
+                       uint64_t *out, int n) { SimAnd2(a, b, a_mask, b_mask, out_mask, out, n); }
+
+template<int W>
+static void OrXorFixed(uint64_t *acc, const uint64_t *a, const uint64_t *b, int) { OrXor<W>(acc, a, b); }
+
+static void OrXorAny(uint64_t *acc, const uint64_t *a, const uint64_t *b, int n) { OrXor(acc, a, b, n); }
+
+template<int W>
+static SimKernels FixedKernels() { return SimKernels{PopXorFixed<W>, SimAnd2Fixed<W>, OrXorFixed<W>}; }
+
+SimKernels GetSimKernels(int n_words) {
+    switch (n_words) {
+        case 16:
+            return FixedKernels<16>();
+        case 64:
+            return FixedKernels<64>();
+        case 256:
+            return FixedKernels<256>();
+        case 1024:
+            return FixedKernels<1024>();
+        default:
+            return SimKernels{PopXorAny, SimAnd2Any, OrXorAny};
+    }
+}
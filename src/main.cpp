@@ -20,11 +20,16 @@ using namespace abc_plus;
 
 void Test();
 
+bool Validate();
+
 void Execute();
 
 void PreproBenchtoAigBlif(const path &bench_dir, const path &blif_dir, const std::vector<std::string> &files);
 
 int main(int argc, char *argv[]) {
+    // the differential checks take minutes, they only run on request
+    if (argc > 1 && std::string(argv[1]) == "--validate")
+        return Validate() ? 0 : 1;
     Test();
     Execute();
     return 0;
@@ -57,6 +62,26 @@ void Test() {
     std::cout << "---------------------------------------------------------------------------" << std::endl;
 }
 
+bool Validate() {
+    auto playground = Playground::GetPlayground();
+    std::cout << "---------------------------------------------------------------------------" << std::endl;
+    std::cout << "> Chained Substitution" << std::endl;
+    std::cout << "---------------------------------------------------------------------------" << std::endl;
+    bool same = playground->ChainedSubstitution();
+    std::cout << "---------------------------------------------------------------------------" << std::endl;
+    std::cout << "> Parallel Max Flow" << std::endl;
+    std::cout << "---------------------------------------------------------------------------" << std::endl;
+    playground->ParallelMaxFlow();
+    std::cout << "---------------------------------------------------------------------------" << std::endl;
+    std::cout << "> Differential Validation" << std::endl;
+    std::cout << "---------------------------------------------------------------------------" << std::endl;
+    same &= playground->DifferentialValidation();
+    std::cout << "---------------------------------------------------------------------------" << std::endl;
+    std::cout << (same ? "> Validation Finished" : "> Validation Failed: the engines disagree") << std::endl;
+    std::cout << "---------------------------------------------------------------------------" << std::endl;
+    return same;
+}
+
 void Execute() {
     path project_source_dir(PROJECT_SOURCE_DIR);
     path out_dir = project_source_dir / "out";
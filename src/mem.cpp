@@ -0,0 +1,181 @@
+/**
+ * @file mem.cpp
+ * @brief
+ * @author Nathan Zhou
+ * @date 2019-02-25
+ * @bug No known bugs.
+ */
+
+#include <cstdlib>
+#include <algorithm>
+#include <new>
+#include <cstring>
+#include <iostream>
+#include <mem.h>
+
+#ifdef __linux__
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#endif
+
+static const size_t HUGE_PAGE_BYTES = 2 << 20;
+
+#if defined(__linux__) && defined(SYS_mbind) && defined(SYS_get_mempolicy)
+
+// values of linux/mempolicy.h, the raw system calls spare the libnuma dependency
+static const unsigned long MPOL_INTERLEAVE_MODE = 3;
+static const unsigned long MPOL_F_MEMS_ALLOWED_FLAG = 1 << 2;
+static const unsigned long MAX_NUMA_NODES = 1024;
+
+/* Every simulation block and every scored target reads the rows of all levels, so no split of the rows among
+ * the workers matches the accesses. The pages go round-robin over the allowed nodes instead, which evens out
+ * the bandwidth; a failure keeps the default policy */
+static void Interleave(void *p, size_t n_bytes) {
+    unsigned long mask[MAX_NUMA_NODES / (8 * sizeof(unsigned long))] = {0};
+    int mode;
+    if (syscall(SYS_get_mempolicy, &mode, mask, MAX_NUMA_NODES, nullptr, MPOL_F_MEMS_ALLOWED_FLAG) != 0)
+        return;
+    int n_nodes = 0;
+    for (auto const &word : mask)
+        n_nodes += __builtin_popcountl(word);
+    // a single node has nothing to interleave, the kernel reads one bit less than the given node count
+    if (n_nodes > 1)
+        syscall(SYS_mbind, p, n_bytes, MPOL_INTERLEAVE_MODE, mask, MAX_NUMA_NODES + 1, 0UL);
+}
+
+#else
+
+static void Interleave(void *, size_t) {}
+
+#endif
+
+PageBuffer::PageBuffer() : data_(nullptr), n_words_(0), n_bytes_(0), mapped_(false), huge_(false) {}
+
+PageBuffer::PageBuffer(PageBuffer &&other) noexcept : PageBuffer() { *this = std::move(other); }
+
+PageBuffer &PageBuffer::operator=(PageBuffer &&other) noexcept {
+    if (this != &other) {
+        Release();
+        std::swap(data_, other.data_);
+        std::swap(n_words_, other.n_words_);
+        std::swap(n_bytes_, other.n_bytes_);
+        std::swap(mapped_, other.mapped_);
+        std::swap(huge_, other.huge_);
+    }
+    return *this;
+}
+
+PageBuffer::~PageBuffer() { Release(); }
+
+void PageBuffer::Allocate(size_t n_words) {
+    Release();
+    if (n_words == 0)
+        return;
+    n_words_ = n_words;
+    n_bytes_ = n_words * sizeof(uint64_t);
+#ifdef __linux__
+    /* Explicit huge pages first, then transparent huge pages on a normal mapping */
+    if (n_bytes_ >= HUGE_PAGE_BYTES) {
+        size_t n_bytes = (n_bytes_ + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+        void *p = mmap(nullptr, n_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            Interleave(p, n_bytes);
+            data_ = (uint64_t *) p;
+            n_bytes_ = n_bytes;
+            mapped_ = huge_ = true;
+            return;
+        }
+    }
+    void *p = mmap(nullptr, n_bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+        throw std::bad_alloc();
+    Interleave(p, n_bytes_);
+    data_ = (uint64_t *) p;
+    mapped_ = true;
+#ifdef MADV_HUGEPAGE
+    huge_ = n_bytes_ >= HUGE_PAGE_BYTES && madvise(p, n_bytes_, MADV_HUGEPAGE) == 0;
+#endif
+#else
+    data_ = (uint64_t *) std::calloc(n_words_, sizeof(uint64_t));
+    if (data_ == nullptr)
+        throw std::bad_alloc();
+#endif
+}
+
+void PageBuffer::Release() {
+    if (data_ != nullptr) {
+#ifdef __linux__
+        if (mapped_)
+            munmap(data_, n_bytes_);
+#else
+        std::free(data_);
+#endif
+    }
+    data_ = nullptr;
+    n_words_ = n_bytes_ = 0;
+    mapped_ = huge_ = false;
+}
+
+CountingResource::CountingResource(std::pmr::memory_resource *upstream) : upstream_(upstream), bytes_(0),
+                                                                        peak_bytes_(0) {}
+
+size_t CountingResource::GetBytes() const { return bytes_; }
+
+size_t CountingResource::GetPeakBytes() const { return peak_bytes_; }
+
+void CountingResource::ResetPeak() { peak_bytes_ = bytes_.load(); }
+
+void *CountingResource::do_allocate(size_t bytes, size_t alignment) {
+    void *p = upstream_->allocate(bytes, alignment);
+    size_t now = bytes_ += bytes;
+    size_t peak = peak_bytes_.load();
+    while (now > peak && !peak_bytes_.compare_exchange_weak(peak, now));
+    return p;
+}
+
+void CountingResource::do_deallocate(void *p, size_t bytes, size_t alignment) {
+    upstream_->deallocate(p, bytes, alignment);
+    bytes_ -= bytes;
+}
+
+bool CountingResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept { return this == &other; }
+
+/* Objects with their fanin and fanout arrays, plus the SOP covers of the nodes */
+size_t NtkMemBytes(NtkPtr ntk) {
+    size_t bytes = 0;
+    for (int id = 0; id < abc::Abc_NtkObjNumMax(ntk); id++) {
+        auto obj = NtkObjbyID(ntk, id);
+        if (obj == nullptr)
+            continue;
+        bytes += sizeof(abc::Abc_Obj_t) + (abc::Abc_ObjFaninNum(obj) + abc::Abc_ObjFanoutNum(obj)) * sizeof(int);
+        if (ObjIsNode(obj) && abc::Abc_ObjData(obj) != nullptr)
+            bytes += std::strlen((char *) abc::Abc_ObjData(obj)) + 1;
+    }
+    return bytes;
+}
+
+MemoryReport::MemoryReport() : signatures(0), candidates(0), alc_snapshots(0), opt_alcs(0), timing(0), flow(0),
+                               networks(0), sim_64_cycles(0), requested_sim_64_cycles(0) {}
+
+size_t MemoryReport::GetTotal() const {
+    return signatures + candidates + alc_snapshots + opt_alcs + timing + flow + networks;
+}
+
+void MemoryReport::Print() const {
+    auto mb = [](size_t bytes) { return (double) bytes / (double) (1 << 20); };
+    std::cout << "Memory (MB): "
+              << "signatures=" << mb(signatures)
+              << " candidates=" << mb(candidates)
+              << " snapshots=" << mb(alc_snapshots)
+              << " opt_alcs=" << mb(opt_alcs)
+              << " timing=" << mb(timing)
+              << " flow=" << mb(flow)
+              << " networks=" << mb(networks)
+              << " total=" << mb(GetTotal());
+    if (sim_64_cycles < requested_sim_64_cycles)
+        std::cout << " (Sim 64 Cycles lowered from " << requested_sim_64_cycles << " to " << sim_64_cycles << ")";
+    std::cout << std::endl;
+}
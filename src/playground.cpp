@@ -8,11 +8,17 @@
 
 #include <playground.h>
 #include <iostream>
+#include <random>
+#include <set>
+#include <iomanip>
+#include <cmath>
 #include <boost/timer/timer.hpp>
 #include <abc_plus.h>
 #include <sta.h>
 #include <dinic.h>
+#include <push_relabel.h>
 #include <dals.h>
+#include <renumber.h>
 
 using namespace boost::filesystem;
 using namespace abc_plus;
@@ -22,10 +28,74 @@ std::shared_ptr<Playground> Playground::GetPlayground() {
     return playground;
 }
 
+/* Critical error network with random node errors in (0, 1), so that its min cut is unique */
+template<typename AddEdge>
+static void AddCriticalErrorEdges(NtkPtr ntk, std::mt19937 &rng, AddEdge add_edge) {
+    int N = abc::Abc_NtkObjNumMax(ntk) + 1;
+    int source = 0, sink = N - 1;
+    std::uniform_real_distribution<double> error(0, 1);
+    auto time_info = CalcSlack(ntk);
+    for (auto const &obj : NtkTopoSortPINode(ntk))
+        if (time_info.at(obj).slack == 0) {
+            int u = ObjID(obj);
+            if (ObjIsPI(obj))
+                add_edge(source, u, std::numeric_limits<double>::max());
+            else {
+                add_edge(u, u + N, error(rng));
+                if (ObjIsPONode(obj))
+                    add_edge(u + N, sink, std::numeric_limits<double>::max());
+            }
+        }
+    for (auto &[u, vs] : GetCriticalGraph(ntk))
+        for (auto &v : vs) {
+            if (ObjIsPI(NtkObjbyID(ntk, u)))
+                add_edge(u, v, std::numeric_limits<double>::max());
+            else
+                add_edge(u + N, v, std::numeric_limits<double>::max());
+        }
+}
+
+/* Random AIG in SOP form, every node is an AND2 with random fanin phases and every dangling node drives a PO */
+static NtkPtr RandomAIG(int n_pis, int n_nodes, std::mt19937 &rng) {
+    auto ntk = abc::Abc_NtkAlloc(abc::ABC_NTK_LOGIC, abc::ABC_FUNC_SOP, 1);
+    std::vector<ObjPtr> objs;
+    for (int i = 0; i < n_pis; i++)
+        objs.push_back(abc::Abc_NtkCreatePi(ntk));
+    for (int i = 0; i < n_nodes; i++) {
+        // fanins come from a window of the latest objects, so the network gets deep
+        std::uniform_int_distribution<int> pick(std::max(0, (int) objs.size() - 4 * n_pis), (int) objs.size() - 1);
+        int a = pick(rng), b = pick(rng);
+        while (b == a)
+            b = pick(rng);
+        auto node = abc::Abc_NtkCreateNode(ntk);
+        abc::Abc_ObjAddFanin(node, objs[a]);
+        abc::Abc_ObjAddFanin(node, objs[b]);
+        int compl_fanins[2] = {(int) (rng() & 1), (int) (rng() & 1)};
+        node->pData = abc::Abc_SopCreateAnd((abc::Mem_Flex_t *) ntk->pManFunc, 2, compl_fanins);
+        objs.push_back(node);
+    }
+    for (int i = n_pis; i < (int) objs.size(); i++)
+        if (abc::Abc_ObjFanoutNum(objs[i]) == 0)
+            abc::Abc_ObjAddFanin(abc::Abc_NtkCreatePo(ntk), objs[i]);
+    abc::Abc_NtkAddDummyPiNames(ntk);
+    abc::Abc_NtkAddDummyPoNames(ntk);
+    return ntk;
+}
+
+static bool SameErrorReport(const ErrorReport &a, const ErrorReport &b) {
+    return a.n_patterns == b.n_patterns && a.any_err_cnt == b.any_err_cnt && a.po_err_cnt == b.po_err_cnt &&
+           a.hamming_hist == b.hamming_hist;
+}
+
+static const char *SameOrDifferent(bool same) { return same ? "Same" : "Different"; }
+
 void Playground::ApproximateSubstitution(bool verbose) {
     path benchmark_file = benchmark_dir_ / "c17.blif";
     NtkPtr origin_ntk = NtkReadBlif(benchmark_file.string());
     NtkPtr approx_ntk = NtkDuplicate(origin_ntk);
+    // one golden simulation serves both variants
+    GoldenCache golden;
+    golden.Build(origin_ntk, PatternSet(0, 10000));
 
     auto target_node = NtkNodebyName(approx_ntk, "23");
     auto sub_node = NtkNodebyName(approx_ntk, "n9");
@@ -42,14 +112,55 @@ void Playground::ApproximateSubstitution(bool verbose) {
         std::cout << "ObjNumMax: " << abc::Abc_NtkObjNumMax(approx_ntk) << std::endl;
         std::cout << "ObjNum: " << abc::Abc_NtkObjNum(approx_ntk) << std::endl;
     }
-    std::cout << "Substitution: " << SimER(origin_ntk, approx_ntk) << std::endl;
+    std::cout << "Substitution: " << SimER(origin_ntk, approx_ntk) << ", "
+              << SimGoldenER(approx_ntk, golden) << " (Golden Cache)" << std::endl;
     alc->Recover();
     if (verbose) {
         NtkPrintInfo(approx_ntk);
         std::cout << "ObjNumMax: " << abc::Abc_NtkObjNumMax(approx_ntk) << std::endl;
         std::cout << "ObjNum: " << abc::Abc_NtkObjNum(approx_ntk) << std::endl;
     }
-    std::cout << "Recovered: " << SimER(origin_ntk, approx_ntk) << std::endl;
+    std::cout << "Recovered: " << SimER(origin_ntk, approx_ntk) << ", "
+              << SimGoldenER(approx_ntk, golden) << " (Golden Cache)" << std::endl;
+}
+
+/* The substitute of one ALC is the target of another, the batch evaluation must match applying them all */
+bool Playground::ChainedSubstitution() {
+    NtkPtr ntk = NtkReadBlif((benchmark_dir_ / "c880.blif").string());
+    auto dals = DALS::GetDALS();
+    auto settings = dals->GetSettings();
+    dals->SetTargetNtk(ntk);
+    dals->SetSim64Cycles(100);
+    NtkPtr approx_ntk = dals->GetApproxNtk();
+    std::vector<ObjPtr> nodes;
+    for (auto const &obj : NtkTopoSortPINode(approx_ntk))
+        if (ObjIsNode(obj))
+            nodes.push_back(obj);
+    dals->CalcALCs(nodes);
+    auto time_info = CalcSlack(approx_ntk);
+
+    std::mt19937 rng(0);
+    int n_trials = 20, n_same = 0;
+    for (int trial = 0; trial < n_trials; trial++) {
+        ObjPtr x, y;
+        do {
+            x = nodes[rng() % nodes.size()];
+            y = nodes[rng() % nodes.size()];
+        } while (time_info.at(x).arrival_time >= time_info.at(y).arrival_time);
+        ALC alc_x(x, abc::Abc_NtkPi(approx_ntk, (int) (rng() % abc::Abc_NtkPiNum(approx_ntk))), rng() & 1);
+        ALC alc_y(y, x, rng() & 1);
+        double est_err = dals->EvalALCs({&alc_x, &alc_y});
+        std::vector<ALC *> alcs = {&alc_x, &alc_y};
+        dals->DoALCs(alcs);
+        double err = SimGoldenER(approx_ntk, dals->GetGoldenCache());
+        for (auto it = alcs.rbegin(); it != alcs.rend(); it++)
+            (*it)->Recover();
+        n_same += est_err == err;
+    }
+    std::cout << "Chained ALCs: " << n_same << "/" << n_trials << " Same" << std::endl;
+    dals->SetSettings(settings);
+    NtkDelete(ntk);
+    return n_same == n_trials;
 }
 
 void Playground::StaticTimingAnalysis() {
@@ -142,8 +253,292 @@ void Playground::CriticalErrorNetwork() {
     std::cout << "Max Flow: " << dinic.MaxFlow(source, sink) << std::endl;
 }
 
+void Playground::ParallelMaxFlow(int n_threads) {
+    path benchmark_file = benchmark_dir_ / "c6288.blif";
+    NtkPtr ntk = NtkReadBlif(benchmark_file.string());
+
+    int N = abc::Abc_NtkObjNumMax(ntk) + 1;
+    int source = 0, sink = N - 1;
+    Dinic dinic(N * 2);
+    ThreadPool pool(n_threads - 1);    // the calling thread counts, 0 picks the hardware threads
+    PushRelabel push_relabel(N * 2, &pool);
+    auto add_edge = [&](int u, int v, double cap) {
+        dinic.AddEdge(u, v, cap);
+        push_relabel.AddEdge(u, v, cap);
+    };
+
+    std::mt19937 rng(0);
+    AddCriticalErrorEdges(ntk, rng, add_edge);
+
+    boost::timer::cpu_timer timer;
+    auto dinic_cut = dinic.MinCut(source, sink);
+    std::cout << "Dinic:" << timer.format();
+    timer.start();
+    auto push_relabel_cut = push_relabel.MinCut(source, sink);
+    std::cout << "Push-Relabel (" << push_relabel.GetRoundNum() << " rounds):" << timer.format();
+
+    std::set<std::pair<int, int>> dinic_edges, push_relabel_edges;
+    for (auto const &edge : dinic_cut)
+        dinic_edges.emplace(edge.u, edge.v);
+    for (auto const &edge : push_relabel_cut)
+        push_relabel_edges.emplace(edge.u, edge.v);
+    std::cout << "Min Cut Size: " << dinic_edges.size() << ", "
+              << (dinic_edges == push_relabel_edges ? "Same Cut" : "Different Cut") << std::endl;
+    NtkDelete(ntk);
+}
+
 Playground::~Playground() = default;
 
+/* The error of a batch of ALCs applied to the network, which is recovered afterwards */
+static double AppliedER(std::vector<ALC *> alcs, NtkPtr approx_ntk) {
+    auto dals = DALS::GetDALS();
+    dals->DoALCs(alcs);
+    double err = SimGoldenER(approx_ntk, dals->GetGoldenCache());
+    for (auto it = alcs.rbegin(); it != alcs.rend(); it++)
+        (*it)->Recover();
+    return err;
+}
+
+bool Playground::DifferentialValidation() {
+    std::vector<std::pair<std::string, NtkPtr>> ntks;
+    for (auto const &name : {"c17", "c432", "c499", "c880", "c1355", "c1908"})
+        ntks.emplace_back(name, NtkReadBlif((benchmark_dir_ / (std::string(name) + ".blif")).string()));
+    std::mt19937 rng(0);
+    for (auto const &[n_pis, n_nodes] : {std::make_pair(8, 200), std::make_pair(32, 1000), std::make_pair(64, 4000)})
+        ntks.emplace_back("random_" + std::to_string(n_nodes), RandomAIG(n_pis, n_nodes, rng));
+
+    ThreadPool pool;
+    const int n_words = SIG_BLOCK_WORDS + 44;
+    const uint64_t seed = 0;
+    auto dals = DALS::GetDALS();
+    auto settings = dals->GetSettings();
+    bool all_same = true;
+    for (auto const &[name, ntk] : ntks) {
+        auto sorted_objs = NtkTopoSortPINode(ntk);
+
+        /* Signatures of every storage mode against the full matrix, block by block */
+        std::vector<SignatureStore> stores(4);
+        stores[0].Build(ntk, n_words, seed, TruthVecMode::Full);
+        stores[1].Build(ntk, n_words, seed, TruthVecMode::Full, std::vector<ObjPtr>(), false, &pool);
+        stores[2].Build(ntk, n_words, seed, TruthVecMode::OnDemand, std::vector<ObjPtr>(), false, &pool);
+        stores[3].Build(ntk, n_words, seed, TruthVecMode::Streaming, std::vector<ObjPtr>(), false, &pool);
+        bool same_sigs = true;
+        SigScratch ref_scratch, scratch;
+        for (int begin = 0; begin < n_words; begin += SIG_BLOCK_WORDS) {
+            int n = std::min(SIG_BLOCK_WORDS, n_words - begin);
+            for (int i = 1; i < (int) stores.size(); i++) {
+                ref_scratch.Reset();
+                scratch.Reset();
+                for (auto const &obj : sorted_objs) {
+                    auto ref_words = stores[0].Get(obj, begin, n, ref_scratch);
+                    same_sigs &= std::equal(ref_words, ref_words + n, stores[i].Get(obj, begin, n, scratch));
+                }
+            }
+        }
+        auto golden = SimPOTruthVec(ntk, n_words, seed);
+        for (int p = 0; p < abc::Abc_NtkPoNum(ntk); p++) {
+            ref_scratch.Reset();
+            auto words = stores[0].Get(abc::Abc_ObjFanin0(abc::Abc_NtkPo(ntk, p)), 0, n_words, ref_scratch);
+            same_sigs &= std::equal(words, words + n_words, golden.begin() + (size_t) p * n_words);
+        }
+
+        /* Error reports of one substitution by a PI */
+        NtkPtr approx_ntk = NtkDuplicate(ntk);
+        std::vector<ObjPtr> nodes;
+        for (auto const &obj : NtkTopoSortPINode(approx_ntk))
+            if (ObjIsNode(obj))
+                nodes.push_back(obj);
+        ALC alc(nodes[rng() % nodes.size()], abc::Abc_NtkPi(approx_ntk, 0), rng() & 1);
+        // the tracked critical graph follows the substitution and its recovery
+        CriticalGraphTracker tracker;
+        tracker.Reset(approx_ntk);
+        // the tracked timing against a full STA of the edited network
+        auto same_timing = [&]() {
+            bool same = tracker.GetMaxDelay() == GetKMostCriticalPaths(approx_ntk, 1)[0].max_delay;
+            for (auto const &[obj, t_obj] : CalcSlack(approx_ntk))
+                if (ObjIsPI(obj) || abc::Abc_ObjFaninNum(obj) > 0)
+                    same &= tracker.GetArrivalTime(ObjID(obj)) == t_obj.arrival_time &&
+                            tracker.IsCritical(ObjID(obj)) == (t_obj.slack == 0);
+            return same;
+        };
+        int target_id = ObjID(alc.GetTarget());
+        alc.Do();
+        int replacement_id = ObjID(alc.GetReplacement());
+        std::vector<int> edited_ids = {target_id, replacement_id};
+        for (auto const &fan_out : ObjFanouts(alc.GetReplacement()))
+            edited_ids.push_back(ObjID(fan_out));
+        tracker.Update(edited_ids);
+        bool same_tracked = tracker.GetCriticalGraph() == GetCriticalGraph(approx_ntk) && same_timing();
+        auto approx = SimPOTruthVec(approx_ntk, n_words, seed);
+        auto ref_report = SimErrorReport(golden.data(), approx.data(), abc::Abc_NtkPoNum(ntk), n_words);
+        bool same_report = SameErrorReport(ref_report, SimConeErrorReport(approx_ntk, golden.data(), n_words, seed)) &&
+                           SameErrorReport(ref_report,
+                                           SimConeErrorReport(approx_ntk, golden.data(), n_words, seed, &pool));
+        /* The original engines of abc_plus draw their own random patterns, which PatternWord cannot reproduce. Node
+         * simulation is compared bit for bit on the patterns of SimTruthVec, the error rate of SimER only within
+         * the sampling error of both pattern sets */
+        auto ref_truth_vec = SimTruthVec(ntk, false, n_words);
+        auto kernels = GetSimKernels(0);
+        std::vector<uint64_t> node_words(n_words);
+        std::vector<const uint64_t *> fanin_words;
+        bool same_ref = true;
+        for (auto const &obj : sorted_objs) {
+            if (ObjIsPI(obj))
+                continue;
+            fanin_words.clear();
+            for (auto const &fan_in : ObjFanins(obj))
+                fanin_words.push_back(ref_truth_vec.at(fan_in).data());
+            SimNode(obj, fanin_words, node_words.data(), n_words, kernels);
+            same_ref &= std::equal(node_words.begin(), node_words.end(), ref_truth_vec.at(obj).begin());
+        }
+        double ref_err = SimER(ntk, approx_ntk, false, n_words), err = ref_report.GetErrorRate();
+        double n_patterns = 64.0 * n_words;
+        same_ref &= std::fabs(ref_err - err) <=
+                    5 * std::sqrt(std::max(err * (1 - err), 1 / n_patterns) * 2 / n_patterns);
+        alc.Recover();
+        edited_ids = {target_id, replacement_id};
+        for (auto const &fan_out : ObjFanouts(alc.GetTarget()))
+            edited_ids.push_back(ObjID(fan_out));
+        tracker.Update(edited_ids);
+        same_tracked &= tracker.GetCriticalGraph() == GetCriticalGraph(approx_ntk) && same_timing();
+        NtkDelete(approx_ntk);
+
+        /* Slacks are invariant under renumbering, critical edges are the tight edges between zero-slack objects */
+        auto time_info = CalcSlack(ntk);
+        NtkPtr renumbered_ntk = NtkRenumber(ntk);
+        auto renumbered_info = CalcSlack(renumbered_ntk);
+        bool same_slacks = true;
+        for (auto const &obj : sorted_objs)
+            same_slacks &= time_info.at(obj).slack == renumbered_info.at(obj->pCopy).slack &&
+                           time_info.at(obj).arrival_time == renumbered_info.at(obj->pCopy).arrival_time;
+        NtkDelete(renumbered_ntk);
+        std::set<std::pair<int, int>> ref_edges, edges;
+        for (auto const &obj : sorted_objs)
+            for (auto const &fan_out : ObjFanouts(obj))
+                if (!ObjIsPO(fan_out) && time_info.at(obj).slack == 0 && time_info.at(fan_out).slack == 0 &&
+                    time_info.at(fan_out).arrival_time == time_info.at(obj).arrival_time + 1)
+                    ref_edges.emplace(ObjID(obj), ObjID(fan_out));
+        for (auto const &[u, vs] : GetCriticalGraph(ntk))
+            for (auto const &v : vs)
+                edges.emplace(u, v);
+
+        /* Fast estimators of DALS against its pairwise estimate, sampled substitutes of every target */
+        dals->SetTargetNtk(ntk);
+        dals->SetSim64Cycles(n_words);
+        dals->SetSeed(seed);
+        dals->SetLocalApprox(false);
+        dals->SetMemoryBudget(0);
+        dals->SetPatternPool(0);
+        dals->SetTransposedSigs(true);
+        NtkPtr dals_ntk = dals->GetApproxNtk();
+        std::vector<ObjPtr> dals_nodes;
+        for (auto const &obj : NtkTopoSortPINode(dals_ntk))
+            if (ObjIsNode(obj))
+                dals_nodes.push_back(obj);
+        dals->CalcALCs(dals_nodes);
+        bool same_est = true;
+        for (auto const &t_node : dals_nodes) {
+            auto const &cand_alcs = dals->GetCandALCs(t_node);
+            for (size_t i = 0; i < cand_alcs.size(); i += std::max((size_t) 1, cand_alcs.size() / 16)) {
+                double err = dals->EstSubPairError(t_node, cand_alcs[i].GetSubstitute());
+                same_est &= cand_alcs[i].GetError() == (cand_alcs[i].IsComplemented() ? 1 - err : err);
+            }
+        }
+        // a pool of every pattern estimates exactly
+        dals->SetTransposedSigs(false);
+        dals->SetPatternPool(n_words);
+        dals->CalcALCs(dals_nodes);
+        for (int i = 1; i < (int) dals_nodes.size(); i++)
+            for (int k = 0; k < 16; k++) {
+                auto s_node = dals_nodes[rng() % i];
+                same_est &= dals->EstSubPairErrorOnPool(dals_nodes[i], s_node) ==
+                            dals->EstSubPairError(dals_nodes[i], s_node);
+            }
+
+        /* Evaluations of single ALCs and batches against applying them */
+        std::vector<ALC> best_alcs;
+        for (auto const &t_node : dals_nodes)
+            if (!dals->GetCandALCs(t_node).empty())
+                best_alcs.push_back(dals->GetCandALCs(t_node).front());
+        bool same_eval = true;
+        for (int trial = 0; trial < 8 && !best_alcs.empty(); trial++) {
+            auto &alc = best_alcs[rng() % best_alcs.size()];
+            same_eval &= dals->EvalALC(alc) == AppliedER({&alc}, dals_ntk);
+            std::set<int> picked;
+            for (int k = 0; k < 4; k++)
+                picked.insert((int) (rng() % best_alcs.size()));
+            std::vector<ALC *> batch;
+            for (auto const &i : picked)
+                batch.push_back(&best_alcs[i]);
+            same_eval &= dals->EvalALCs(std::vector<const ALC *>(batch.begin(), batch.end())) ==
+                         AppliedER(batch, dals_ntk);
+        }
+
+        /* Max flows and min cuts of the critical error network */
+        int N = abc::Abc_NtkObjNumMax(ntk) + 1;
+        Dinic dinic(N * 2);
+        PushRelabel push_relabel(N * 2), parallel_push_relabel(N * 2, &pool);
+        std::mt19937 flow_rng(0);
+        AddCriticalErrorEdges(ntk, flow_rng, [&](int u, int v, double cap) {
+            dinic.AddEdge(u, v, cap);
+            push_relabel.AddEdge(u, v, cap);
+            parallel_push_relabel.AddEdge(u, v, cap);
+        });
+        auto cut_of = [](const std::vector<Edge> &cut, double &flow) {
+            std::set<std::pair<int, int>> cut_edges;
+            flow = 0;
+            for (auto const &edge : cut) {
+                cut_edges.emplace(edge.u, edge.v);
+                flow += edge.cap;
+            }
+            return cut_edges;
+        };
+        double dinic_flow, flow, parallel_flow;
+        auto dinic_cut = cut_of(dinic.MinCut(0, N - 1), dinic_flow);
+        auto cut = cut_of(push_relabel.MinCut(0, N - 1), flow);
+        auto parallel_cut = cut_of(parallel_push_relabel.MinCut(0, N - 1), parallel_flow);
+        auto close = [&](double x) { return std::abs(x - dinic_flow) <= 1e-9 * std::max(1.0, dinic_flow); };
+
+        bool same_flow = close(flow) && close(parallel_flow);
+        bool same_cut = dinic_cut == cut && dinic_cut == parallel_cut;
+        std::cout << std::setw(12) << std::left << name << std::right
+                  << " Signatures: " << SameOrDifferent(same_sigs)
+                  << ", Original Engines: " << SameOrDifferent(same_ref)
+                  << ", Error Report: " << SameOrDifferent(same_report)
+                  << ", Estimators: " << SameOrDifferent(same_est)
+                  << ", ALC Evaluation: " << SameOrDifferent(same_eval)
+                  << ", Slacks: " << SameOrDifferent(same_slacks)
+                  << ", Critical Graph: " << SameOrDifferent(ref_edges == edges && same_tracked)
+                  << ", Max Flow: " << SameOrDifferent(same_flow)
+                  << ", Min Cut: " << SameOrDifferent(same_cut) << std::endl;
+        all_same &= same_sigs && same_ref && same_report && same_est && same_eval && same_slacks && ref_edges == edges &&
+                    same_tracked && same_flow && same_cut;
+    }
+
+    /* Final networks of the reference engines and of all fast paths with the same seed */
+    dals->SetSettings(settings);
+    auto final_ntk = [&](bool fast) {
+        dals->SetTargetNtk(ntks[3].second);
+        dals->SetSim64Cycles(1000);
+        dals->SetThreads(fast ? 0 : 1);
+        dals->SetTruthVecMode(fast ? TruthVecMode::OnDemand : TruthVecMode::Full);
+        dals->SetTransposedSigs(fast);
+        dals->Run(0.05);
+        return NtkDuplicate(dals->GetApproxNtk());
+    };
+    NtkPtr ref_ntk = final_ntk(false), fast_ntk = final_ntk(true);
+    dals->SetSettings(settings);
+    bool same_final = abc::Abc_NtkObjNum(ref_ntk) == abc::Abc_NtkObjNum(fast_ntk) &&
+                      SimPOTruthVec(ref_ntk, n_words, seed) == SimPOTruthVec(fast_ntk, n_words, seed) &&
+                      GetKMostCriticalPaths(ref_ntk, 1)[0].max_delay == GetKMostCriticalPaths(fast_ntk, 1)[0].max_delay;
+    std::cout << "Final Network: " << SameOrDifferent(same_final) << std::endl;
+    NtkDelete(ref_ntk);
+    NtkDelete(fast_ntk);
+    for (auto const &[name, ntk] : ntks)
+        NtkDelete(ntk);
+    return all_same && same_final;
+}
+
 Playground::Playground() : project_source_dir_(PROJECT_SOURCE_DIR) {
     benchmark_dir_ = project_source_dir_ / "benchmark" / "blif";
     out_dir_ = project_source_dir_ / "out";
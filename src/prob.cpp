@@ -0,0 +1,70 @@
+/**
+ * @file prob.cpp
+ * @brief
+ * @author Nathan Zhou
+ * @date 2019-02-12
+ * @bug Signal probabilities assume independent fanins, so they are only approximate under reconvergence.
+ *      The prefilter built on them is therefore a heuristic, not a sound bound, and it is scoped to signal
+ *      probabilities only: candidates are ranked by their local disagreement, which observability does not change,
+ *      so no backward observability pass is computed.
+ */
+
+#include <iostream>
+#include <cmath>
+#include <prob.h>
+
+ProbObject::ProbObject(double probability) : probability(probability) {}
+
+/* Probability of a SOP node being 1, assuming independent fanins and independent cubes. */
+static double SopProb(ObjPtr node, const std::vector<double> &fanin_probs) {
+    auto sop = (char *) abc::Abc_ObjData(node);
+    auto n_vars = (int) fanin_probs.size();
+    double not_one = 1;
+    for (char *cube = sop; *cube; cube += n_vars + 3) {
+        double cube_prob = 1;
+        for (int i = 0; i < n_vars; i++) {
+            if (cube[i] == '1')
+                cube_prob *= fanin_probs[i];
+            else if (cube[i] == '0')
+                cube_prob *= 1 - fanin_probs[i];
+        }
+        not_one *= 1 - cube_prob;
+    }
+    return abc::Abc_SopIsComplement(sop) ? not_one : 1 - not_one;
+}
+
+std::unordered_map<ObjPtr, ProbObject> CalcSignalProb(NtkPtr ntk, bool print_result) {
+    std::vector<ObjPtr> sorted_objs = NtkTopoSortPINode(ntk);
+
+    std::unordered_map<ObjPtr, ProbObject> p_objs;
+
+    /* Initialization */
+    for (auto const &obj : sorted_objs)
+        p_objs.emplace(obj, ProbObject(0.5));
+
+    /* Update signal probability */
+    std::vector<double> fanin_probs;
+    for (auto const &obj : sorted_objs) {
+        if (ObjIsPI(obj))
+            continue;
+        fanin_probs.clear();
+        for (auto const &fan_in : ObjFanins(obj))
+            fanin_probs.push_back(p_objs.at(fan_in).probability);
+        p_objs.at(obj).probability = SopProb(obj, fanin_probs);
+    }
+
+    if (print_result) {
+        for (auto const &obj : sorted_objs)
+            std::cout << ObjName(obj) << "=" << p_objs.at(obj).probability << " ";
+        std::cout << std::endl;
+    }
+    return p_objs;
+}
+
+double EstSubPairErrorLowerBound(const ProbObject &target, const ProbObject &substitute, bool allow_complement) {
+    // P(t != s) >= |P(t) - P(s)| holds for any correlation between t and s
+    double bound = std::fabs(target.probability - substitute.probability);
+    if (allow_complement)
+        bound = std::min(bound, std::fabs(target.probability + substitute.probability - 1));
+    return bound;
+}
@@ -0,0 +1,273 @@
+/**
+ * @file push_relabel.cpp
+ * @brief
+ * @author Nathan Zhou
+ * @date 2019-02-26
+ * @bug No known bugs.
+ */
+
+#include <limits>
+#include <cmath>
+#include <algorithm>
+#include <push_relabel.h>
+
+static void AtomicAdd(std::atomic<double> &a, double d, double &old) {
+    old = a.load(std::memory_order_relaxed);
+    while (!a.compare_exchange_weak(old, old + d, std::memory_order_relaxed));
+}
+
+PushRelabel::PushRelabel(int N, ThreadPool *pool, std::pmr::memory_resource *mr)
+        : N(N), pool(pool), n_slots(pool ? pool->GetSlotNum() : 1),
+          n_rounds(0), quantum_bits(40), quantum(0), E(mr), G(N, mr), cap(mr), height(N, 0, mr),
+          new_height(N, 0, mr), excess(N, mr), mark(N, mr), visited(mr), frontier(mr),
+          next_frontier((N + 63) / 64, mr) {}
+
+void PushRelabel::AddEdge(int u, int v, double cap) {
+    if (u != v) {
+        E.emplace_back(Edge(u, v, cap));
+        G[u].emplace_back(E.size() - 1);
+        E.emplace_back(Edge(v, u, 0));
+        G[v].emplace_back(E.size() - 1);
+    }
+}
+
+void PushRelabel::SetQuantumBits(int quantum_bits) { this->quantum_bits = std::min(std::max(quantum_bits, 1), 44); }
+
+int PushRelabel::GetRoundNum() const { return n_rounds; }
+
+double PushRelabel::Residual(int k) const { return cap[k] - E[k].flow; }
+
+/* Small ranges are not worth the tasks */
+template<typename Func>
+void PushRelabel::ParallelRange(int n, Func func, int grain) {
+    if (!pool) {
+        func(0, n, 0);
+        return;
+    }
+    pool->ParallelRange(n, grain, func);
+}
+
+/* Exact distances to the sink in the residual graph, then to the source shifted by N, 2N when neither. Both are
+ * level-synchronous BFS on bitset frontiers as in Dinic::BFS, every level expanded in parallel. Top-down, the
+ * frontier words are split over the workers and the next frontier is set with atomic ORs. Bottom-up, every
+ * worker owns the words of the unvisited vertices it looks up parents for. Heights are only written between
+ * levels, from the words of the next frontier. */
+void PushRelabel::GlobalRelabel(int S, int T) {
+    static const int word_grain = 4;
+    int n_words = (N + 63) / 64;
+    std::fill(height.begin(), height.end(), 2 * N);
+    visited.assign(n_words, 0);
+    frontier.resize(n_words);
+    std::vector<long long> n_next(n_slots), m_next(n_slots);
+    long long m_unvisited = (long long) E.size();
+    auto bfs = [&](int root, int base) {
+        std::fill(frontier.begin(), frontier.end(), 0);
+        frontier[root >> 6] |= (uint64_t) 1 << (root & 63);
+        visited[root >> 6] |= (uint64_t) 1 << (root & 63);
+        height[root] = base;
+        long long n_frontier = 1, m_frontier = G[root].size();
+        m_unvisited -= m_frontier;
+        bool bottom_up = false;
+        for (int d = 0; n_frontier > 0; d++) {
+            if (!bottom_up && m_frontier * 14 > m_unvisited)
+                bottom_up = true;
+            else if (bottom_up && n_frontier * 24 < N)
+                bottom_up = false;
+
+            for (auto &word : next_frontier)
+                word.store(0, std::memory_order_relaxed);
+            if (bottom_up) {
+                ParallelRange(n_words, [&](int begin, int end, int) {
+                    for (int w = begin; w < end; w++) {
+                        uint64_t found = 0;
+                        for (uint64_t bits = ~visited[w]; bits; bits &= bits - 1) {
+                            int v = w * 64 + __builtin_ctzll(bits);
+                            if (v >= N)
+                                break;
+                            for (int k : G[v]) {
+                                int u = E[k].v;
+                                if ((frontier[u >> 6] >> (u & 63) & 1) && Residual(k) > 0) {
+                                    found |= (uint64_t) 1 << (v & 63);
+                                    break;
+                                }
+                            }
+                        }
+                        next_frontier[w].store(found, std::memory_order_relaxed);
+                    }
+                }, word_grain);
+            } else {
+                ParallelRange(n_words, [&](int begin, int end, int) {
+                    for (int w = begin; w < end; w++)
+                        for (uint64_t bits = frontier[w]; bits; bits &= bits - 1) {
+                            int u = w * 64 + __builtin_ctzll(bits);
+                            for (int k : G[u]) {
+                                int v = E[k].v;
+                                if (!(visited[v >> 6] >> (v & 63) & 1) && Residual(k ^ 1) > 0)
+                                    next_frontier[v >> 6].fetch_or((uint64_t) 1 << (v & 63),
+                                                                   std::memory_order_relaxed);
+                            }
+                        }
+                }, word_grain);
+            }
+
+            std::fill(n_next.begin(), n_next.end(), 0);
+            std::fill(m_next.begin(), m_next.end(), 0);
+            ParallelRange(n_words, [&](int begin, int end, int t) {
+                for (int w = begin; w < end; w++) {
+                    uint64_t bits = next_frontier[w].load(std::memory_order_relaxed);
+                    frontier[w] = bits;
+                    visited[w] |= bits;
+                    for (; bits; bits &= bits - 1) {
+                        int v = w * 64 + __builtin_ctzll(bits);
+                        height[v] = base + d + 1;
+                        n_next[t]++;
+                        m_next[t] += G[v].size();
+                    }
+                }
+            }, word_grain);
+            n_frontier = m_frontier = 0;
+            for (int t = 0; t < n_slots; t++) {
+                n_frontier += n_next[t];
+                m_frontier += m_next[t];
+            }
+            m_unvisited -= m_frontier;
+        }
+    };
+    bfs(T, 0);
+    bfs(S, N);
+}
+
+double PushRelabel::MaxFlow(int S, int T) {
+    /* Infinite capacities are bounded by the total finite capacity, which no cut can exceed */
+    double bound = 1;
+    for (size_t k = 0; k < E.size(); k += 2)
+        if (E[k].cap < std::numeric_limits<double>::max())
+            bound += E[k].cap;
+    /* An excess never exceeds the bound, so its sums are exact to 2^-52 of it and a capacity below that would be
+     * lost. The quantum stays 2^8 above, enough for the rounding of the pushes into one excess to stay below half
+     * a quantum, which is the threshold of a positive residual in MinCut. The ALC errors that make up the finite
+     * capacities are counts of 2^-(6 + log2 sim_64_cycles), far above the quantum of any practical pattern set. */
+    quantum = std::ldexp(bound, -quantum_bits);
+    cap.resize(E.size());
+    for (size_t k = 0; k < E.size(); k++) {
+        cap[k] = E[k].cap > 0 ? std::min(std::max(E[k].cap, quantum), bound) : 0;
+        E[k].flow = 0;
+    }
+    for (int u = 0; u < N; u++) {
+        excess[u] = 0;
+        mark[u] = -1;
+    }
+
+    double old;
+    for (int k : G[S])
+        if (cap[k] > 0) {
+            E[k].flow += cap[k];
+            E[k ^ 1].flow -= cap[k];
+            AtomicAdd(excess[E[k].v], cap[k], old);
+            AtomicAdd(excess[S], -cap[k], old);
+        }
+
+    std::vector<int> active, relabeled;
+    std::vector<std::vector<int>> next(n_slots), to_relabel(n_slots);
+    auto is_active = [&](int u) { return u != S && u != T && height[u] < 2 * N && excess[u] > 0; };
+    long long n_relabels = 0;
+    n_rounds = 0;
+    while (true) {
+        /* Global relabeling on the first round and after every N relabels */
+        if (n_rounds == 0 || n_relabels >= N) {
+            GlobalRelabel(S, T);
+            n_relabels = 0;
+            active.clear();
+            for (int u = 0; u < N; u++)
+                if (is_active(u))
+                    active.push_back(u);
+        }
+        if (active.empty())
+            break;
+        n_rounds++;
+
+        /* Push phase, heights are frozen */
+        for (int t = 0; t < n_slots; t++) {
+            next[t].clear();
+            to_relabel[t].clear();
+        }
+        int round = n_rounds;
+        ParallelRange((int) active.size(), [&](int begin, int end, int t) {
+            double old_excess;
+            for (int i = begin; i < end; i++) {
+                int u = active[i];
+                double e = excess[u].load(std::memory_order_relaxed);
+                for (int k : G[u]) {
+                    if (e <= 0) break;
+                    int v = E[k].v;
+                    if (height[u] != height[v] + 1)
+                        continue;
+                    double cf = Residual(k);
+                    if (cf <= 0)
+                        continue;
+                    double d = std::min(e, cf);
+                    E[k].flow += d;
+                    E[k ^ 1].flow -= d;
+                    e -= d;
+                    AtomicAdd(excess[u], -d, old_excess);
+                    AtomicAdd(excess[v], d, old_excess);
+                    if (v != S && v != T && mark[v].exchange(round) != round)
+                        next[t].push_back(v);
+                }
+                if (e > 0)
+                    to_relabel[t].push_back(u);
+                else if (excess[u] > 0 && mark[u].exchange(round) != round)
+                    next[t].push_back(u);
+            }
+        });
+
+        /* Relabel phase, once no edge of the relabeled vertices changes anymore */
+        relabeled.clear();
+        for (auto const &list : to_relabel)
+            relabeled.insert(relabeled.end(), list.begin(), list.end());
+        ParallelRange((int) relabeled.size(), [&](int begin, int end, int t) {
+            for (int i = begin; i < end; i++) {
+                int u = relabeled[i];
+                int h = 2 * N;
+                for (int k : G[u])
+                    if (Residual(k) > 0)
+                        h = std::min(h, height[E[k].v] + 1);
+                new_height[u] = std::max(h, height[u] + 1);
+            }
+        });
+        for (int u : relabeled) {
+            height[u] = std::min(new_height[u], 2 * N);
+            if (mark[u].exchange(round) != round)
+                next[0].push_back(u);
+        }
+        n_relabels += relabeled.size();
+
+        active.clear();
+        for (auto const &list : next)
+            for (int u : list)
+                if (is_active(u))
+                    active.push_back(u);
+    }
+    return excess[T];
+}
+
+std::vector<Edge> PushRelabel::MinCut(int S, int T) {
+    MaxFlow(S, T);
+    std::vector<bool> visited(N, false);
+    std::vector<int> stack({S});
+    visited[S] = true;
+    while (!stack.empty()) {
+        int u = stack.back();
+        stack.pop_back();
+        for (int k : G[u])
+            if (!visited[E[k].v] && Residual(k) > quantum / 2) {
+                visited[E[k].v] = true;
+                stack.push_back(E[k].v);
+            }
+    }
+    std::vector<Edge> min_cut;
+    for (size_t k = 0; k < E.size(); k += 2)
+        if (E[k].cap > 0 && E[k].flow > 0 && visited[E[k].u] && !visited[E[k].v])
+            min_cut.push_back(E[k]);
+    return min_cut;
+}
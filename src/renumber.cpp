@@ -0,0 +1,55 @@
+/**
+ * @file renumber.cpp
+ * @brief
+ * @author Nathan Zhou
+ * @date 2019-02-16
+ * @bug No known bugs.
+ */
+
+#include <unordered_set>
+#include <renumber.h>
+
+std::vector<ObjPtr> NtkDFSOrder(NtkPtr ntk) {
+    std::vector<ObjPtr> dfs_order;
+    std::unordered_set<ObjPtr> visited;
+    std::vector<std::pair<ObjPtr, int>> stack;
+
+    auto visit = [&](ObjPtr root) {
+        if (!visited.insert(root).second)
+            return;
+        stack.emplace_back(root, 0);
+        while (!stack.empty()) {
+            auto &[obj, i] = stack.back();
+            if (ObjIsNode(obj) && i < abc::Abc_ObjFaninNum(obj)) {
+                auto fan_in = abc::Abc_ObjFanin(obj, i++);
+                if (visited.insert(fan_in).second)
+                    stack.emplace_back(fan_in, 0);
+            } else {
+                if (ObjIsNode(obj))
+                    dfs_order.push_back(obj);
+                stack.pop_back();
+            }
+        }
+    };
+
+    /* Post-order DFS from the PO drivers keeps the fanins of a node next to it */
+    for (int i = 0; i < abc::Abc_NtkPoNum(ntk); i++)
+        visit(abc::Abc_ObjFanin0(abc::Abc_NtkPo(ntk, i)));
+    /* Dangling nodes are kept in topological order */
+    for (auto const &obj : NtkTopoSortPINode(ntk))
+        if (ObjIsNode(obj))
+            visit(obj);
+    return dfs_order;
+}
+
+NtkPtr NtkRenumber(NtkPtr ntk) {
+    auto new_ntk = abc::Abc_NtkStartFrom(ntk, abc::Abc_NtkType(ntk), abc::Abc_NtkFuncType(ntk));
+    auto dfs_order = NtkDFSOrder(ntk);
+    for (auto const &obj : dfs_order)
+        abc::Abc_NtkDupObj(new_ntk, obj, 1);
+    for (auto const &obj : dfs_order)
+        for (auto const &fan_in : ObjFanins(obj))
+            abc::Abc_ObjAddFanin(obj->pCopy, fan_in->pCopy);
+    abc::Abc_NtkFinalize(ntk, new_ntk);
+    return new_ntk;
+}
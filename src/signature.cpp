@@ -0,0 +1,451 @@
+/**
+ * @file signature.cpp
+ * @brief
+ * @author Nathan Zhou
+ * @date 2019-02-18
+ * @bug No known bugs.
+ */
+
+#include <algorithm>
+#include <unordered_set>
+#include <mutex>
+#include <bitset>
+
+// resolve conflict between cpu timers and original timers (deprecated) in boost library
+#define timer timer_deprecated
+
+#include <boost/progress.hpp>
+
+#undef timer
+
+#include <signature.h>
+#include <sim.h>
+#include <kernel.h>
+
+/* Random patterns of PI i only depend on the seed and i, so every network with the same interface sees the same
+ * patterns, whichever thread fills which rows */
+template<typename RowOfPI>
+static void SimPIPatterns(NtkPtr ntk, int n_words, uint64_t seed, RowOfPI row_of_pi, ThreadPool *pool = nullptr) {
+    auto fill = [&](int i, int) {
+        uint64_t *row = row_of_pi(i);
+        for (int w = 0; w < n_words; w++)
+            row[w] = PatternWord(seed, i, w);
+    };
+    if (pool)
+        pool->ParallelFor(abc::Abc_NtkPiNum(ntk), fill);
+    else
+        for (int i = 0; i < abc::Abc_NtkPiNum(ntk); i++)
+            fill(i, 0);
+}
+
+uint64_t *SigScratch::Alloc(int n_words) {
+    if (top_ == buffers_.size())
+        buffers_.emplace_back();
+    auto &buffer = buffers_[top_++];
+    if (buffer.size() < (size_t) n_words)
+        buffer.resize(n_words);
+    return buffer.data();
+}
+
+std::vector<const uint64_t *> &SigScratch::PushFanins() {
+    if (fanins_top_ == fanins_.size())
+        fanins_.emplace_back();
+    auto &fanins = fanins_[fanins_top_++];
+    fanins.clear();
+    return fanins;
+}
+
+void SigScratch::PopFanins() { fanins_top_--; }
+
+void SigScratch::Reset() {
+    top_ = 0;
+    ClearMemo();
+}
+
+const uint64_t *SigScratch::Lookup(int id, int word_begin, int n_words) const {
+    if (word_begin != memo_begin_ || n_words != memo_n_ || id >= (int) memo_.size())
+        return nullptr;
+    return memo_[id];
+}
+
+void SigScratch::Memo(int id, int word_begin, int n_words, const uint64_t *words) {
+    if (word_begin != memo_begin_ || n_words != memo_n_) {
+        ClearMemo();
+        memo_begin_ = word_begin;
+        memo_n_ = n_words;
+    }
+    if (id >= (int) memo_.size())
+        memo_.resize(id + 1, nullptr);
+    memo_[id] = words;
+    memo_ids_.push_back(id);
+}
+
+void SigScratch::ClearMemo() {
+    for (auto id : memo_ids_)
+        memo_[id] = nullptr;
+    memo_ids_.clear();
+}
+
+SignatureStore::SignatureStore() : n_words_(0), mode_(TruthVecMode::Full), n_stored_(0),
+                                   block_kernels_(GetSimKernels(SIG_BLOCK_WORDS)), tail_kernels_(GetSimKernels(0)),
+                                   any_kernels_(GetSimKernels(0)) {}
+
+void SignatureStore::Build(NtkPtr ntk, int n_words, uint64_t seed, TruthVecMode mode,
+                           const std::vector<ObjPtr> &keep_nodes, bool show_progress_bar, ThreadPool *pool) {
+    n_words_ = n_words;
+    mode_ = mode;
+    tail_kernels_ = GetSimKernels(n_words % SIG_BLOCK_WORDS);
+    auto sorted_objs = NtkTopoSortPINode(ntk);
+    std::unordered_set<ObjPtr> keep(keep_nodes.begin(), keep_nodes.end());
+
+    /* Rows are only kept for PIs, multi-fanout nodes, PO drivers and the requested nodes,
+     * the other nodes sit in fanout-free regions and are recomputed from them on demand.
+     * Streaming keeps the PIs only and recomputes whole cones, sharing the reconvergent nodes in the scratch */
+    n_stored_ = 0;
+    row_.assign(abc::Abc_NtkObjNumMax(ntk), -1);
+    std::vector<ObjPtr> stored_nodes;
+    for (auto const &obj : sorted_objs)
+        if (mode == TruthVecMode::Full || ObjIsPI(obj) ||
+            (mode == TruthVecMode::OnDemand &&
+             (abc::Abc_ObjFanoutNum(obj) != 1 || ObjIsPONode(obj) || keep.count(obj)))) {
+            row_[ObjID(obj)] = (int) n_stored_++;
+            if (!ObjIsPI(obj))
+                stored_nodes.push_back(obj);
+        }
+    data_.Allocate(n_stored_ * n_words_);
+
+    SimPIPatterns(ntk, n_words_, seed, [&](int i) {
+        return &data_[(size_t) row_[ObjID(abc::Abc_NtkPi(ntk, i))] * n_words_];
+    }, pool);
+
+    /* Simulation in cache-sized blocks, which are independent of each other */
+    boost::progress_display *pd = nullptr;
+    std::mutex pd_mtx;
+    int n_blocks = (n_words_ + SIG_BLOCK_WORDS - 1) / SIG_BLOCK_WORDS;
+    if (show_progress_bar) pd = new boost::progress_display(n_blocks);
+    int n_slots = pool ? pool->GetSlotNum() : 1;
+    std::vector<SigScratch> scratches(n_slots);
+    std::vector<std::vector<const uint64_t *>> fanin_words(n_slots);
+    auto sim_block = [&](int block, int slot) {
+        int begin = block * SIG_BLOCK_WORDS;
+        int n = std::min(SIG_BLOCK_WORDS, n_words_ - begin);
+        for (auto const &node : stored_nodes) {
+            scratches[slot].Reset();
+            fanin_words[slot].clear();
+            for (int i = 0; i < abc::Abc_ObjFaninNum(node); i++)
+                fanin_words[slot].push_back(Get(abc::Abc_ObjFanin(node, i), begin, n, scratches[slot]));
+            SimNode(node, fanin_words[slot], &data_[(size_t) row_[ObjID(node)] * n_words_ + begin], n, GetKernels(n));
+        }
+        if (show_progress_bar) {
+            std::lock_guard<std::mutex> lock(pd_mtx);
+            ++(*pd);
+        }
+    };
+    if (pool)
+        pool->ParallelFor(n_blocks, sim_block);
+    else
+        for (int block = 0; block < n_blocks; block++)
+            sim_block(block, 0);
+    delete pd;
+}
+
+bool SignatureStore::IsStored(ObjPtr obj) const { return row_[ObjID(obj)] >= 0; }
+
+int SignatureStore::GetWordNum() const { return n_words_; }
+
+size_t SignatureStore::GetStoredNum() const { return n_stored_; }
+
+/* The block and tail widths of the store, any other range takes the generic kernels */
+const SimKernels &SignatureStore::GetKernels(int n_words) const {
+    if (n_words == SIG_BLOCK_WORDS)
+        return block_kernels_;
+    return n_words == n_words_ % SIG_BLOCK_WORDS ? tail_kernels_ : any_kernels_;
+}
+
+size_t SignatureStore::GetMemBytes() const { return data_.Size() * sizeof(uint64_t) + VectorBytes(row_); }
+
+const uint64_t *SignatureStore::Get(ObjPtr obj, int word_begin, int n_words, SigScratch &scratch) const {
+    int row = row_[ObjID(obj)];
+    if (row >= 0)
+        return &data_[(size_t) row * n_words_ + word_begin];
+    bool streaming = mode_ == TruthVecMode::Streaming;
+    if (streaming)
+        if (auto words = scratch.Lookup(ObjID(obj), word_begin, n_words))
+            return words;
+    // a deque level stays in place while the deeper calls push theirs
+    auto &fanin_words = scratch.PushFanins();
+    for (int i = 0; i < abc::Abc_ObjFaninNum(obj); i++)
+        fanin_words.push_back(Get(abc::Abc_ObjFanin(obj, i), word_begin, n_words, scratch));
+    uint64_t *out = scratch.Alloc(n_words);
+    SimNode(obj, fanin_words, out, n_words, GetKernels(n_words));
+    scratch.PopFanins();
+    if (streaming)
+        scratch.Memo(ObjID(obj), word_begin, n_words, out);
+    return out;
+}
+
+std::vector<uint64_t> SimPOTruthVec(NtkPtr ntk, int n_words, uint64_t seed) {
+    static const int block_words = 16;
+    auto sorted_objs = NtkTopoSortPINode(ntk);
+    int n_pis = abc::Abc_NtkPiNum(ntk), n_pos = abc::Abc_NtkPoNum(ntk);
+    std::vector<uint64_t> pi_truth_vec((size_t) n_pis * n_words), po_truth_vec((size_t) n_pos * n_words);
+    SimPIPatterns(ntk, n_words, seed, [&](int i) { return &pi_truth_vec[(size_t) i * n_words]; });
+    std::vector<int> pi_index(abc::Abc_NtkObjNumMax(ntk), -1);
+    for (int i = 0; i < n_pis; i++)
+        pi_index[ObjID(abc::Abc_NtkPi(ntk, i))] = i;
+
+    /* Only a narrow block of every node is alive at a time */
+    std::vector<uint64_t> block((size_t) abc::Abc_NtkObjNumMax(ntk) * block_words);
+    std::vector<const uint64_t *> fanin_words;
+    SimKernels block_kernels = GetSimKernels(block_words), tail_kernels = GetSimKernels(n_words % block_words);
+    for (int begin = 0; begin < n_words; begin += block_words) {
+        int n = std::min(block_words, n_words - begin);
+        auto const &kernels = n == block_words ? block_kernels : tail_kernels;
+        for (auto const &obj : sorted_objs) {
+            uint64_t *row = &block[(size_t) ObjID(obj) * block_words];
+            if (ObjIsPI(obj)) {
+                std::copy_n(&pi_truth_vec[(size_t) pi_index[ObjID(obj)] * n_words + begin], n, row);
+                continue;
+            }
+            fanin_words.clear();
+            for (int i = 0; i < abc::Abc_ObjFaninNum(obj); i++)
+                fanin_words.push_back(&block[(size_t) ObjID(abc::Abc_ObjFanin(obj, i)) * block_words]);
+            SimNode(obj, fanin_words, row, n, kernels);
+        }
+        for (int i = 0; i < n_pos; i++)
+            std::copy_n(&block[(size_t) ObjID(abc::Abc_ObjFanin0(abc::Abc_NtkPo(ntk, i))) * block_words], n,
+                        &po_truth_vec[(size_t) i * n_words + begin]);
+    }
+    return po_truth_vec;
+}
+
+/* Transitive fanin cone of every PO driver, PIs included, in topological order */
+static std::vector<std::vector<int>> POCones(NtkPtr ntk, const std::vector<ObjPtr> &sorted_objs) {
+    int n_pos = abc::Abc_NtkPoNum(ntk);
+    std::vector<int> mark(abc::Abc_NtkObjNumMax(ntk), -1);
+    std::vector<std::vector<int>> cones(n_pos);
+    std::vector<ObjPtr> stack;
+    for (int p = 0; p < n_pos; p++) {
+        stack.assign(1, abc::Abc_ObjFanin0(abc::Abc_NtkPo(ntk, p)));
+        mark[ObjID(stack[0])] = p;
+        while (!stack.empty()) {
+            auto obj = stack.back();
+            stack.pop_back();
+            cones[p].push_back(ObjID(obj));
+            for (int i = 0; i < abc::Abc_ObjFaninNum(obj); i++) {
+                auto fanin = abc::Abc_ObjFanin(obj, i);
+                if (mark[ObjID(fanin)] != p) {
+                    mark[ObjID(fanin)] = p;
+                    stack.push_back(fanin);
+                }
+            }
+        }
+    }
+    std::vector<int> topo_index(abc::Abc_NtkObjNumMax(ntk), 0);
+    for (int i = 0; i < (int) sorted_objs.size(); i++)
+        topo_index[ObjID(sorted_objs[i])] = i;
+    for (auto &cone : cones)
+        std::sort(cone.begin(), cone.end(), [&](int a, int b) { return topo_index[a] < topo_index[b]; });
+    return cones;
+}
+
+/* Greedy grouping, largest cones first, each into the group that ends up with the fewest nodes to simulate,
+ * so POs sharing most of their cones fall into one group while the groups stay balanced */
+static std::vector<std::vector<int>> GroupCones(const std::vector<std::vector<int>> &cones, int n_obj_max,
+                                                int n_groups) {
+    n_groups = std::max(1, std::min(n_groups, std::min(64, (int) cones.size())));
+    std::vector<int> order(cones.size());
+    for (int p = 0; p < (int) cones.size(); p++)
+        order[p] = p;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return cones[a].size() > cones[b].size(); });
+    std::vector<uint64_t> in_group(n_obj_max, 0);
+    std::vector<long long> load(n_groups, 0);
+    std::vector<std::vector<int>> groups(n_groups);
+    for (auto p : order) {
+        int best = 0;
+        long long best_load = -1;
+        for (int g = 0; g < n_groups; g++) {
+            long long new_load = load[g];
+            for (auto id : cones[p])
+                new_load += !((in_group[id] >> g) & 1);
+            if (best_load < 0 || new_load < best_load) {
+                best = g;
+                best_load = new_load;
+            }
+        }
+        for (auto id : cones[p])
+            in_group[id] |= 1ULL << best;
+        load[best] = best_load;
+        groups[best].push_back(p);
+    }
+    groups.erase(std::remove_if(groups.begin(), groups.end(), [](const std::vector<int> &g) { return g.empty(); }),
+                 groups.end());
+    for (auto &group : groups)
+        std::sort(group.begin(), group.end());
+    return groups;
+}
+
+std::vector<std::vector<int>> GroupPOCones(NtkPtr ntk, int n_groups) {
+    return GroupCones(POCones(ntk, NtkTopoSortPINode(ntk)), abc::Abc_NtkObjNumMax(ntk), n_groups);
+}
+
+ErrorReport SimConeErrorReport(NtkPtr ntk, const uint64_t *golden, int n_words, uint64_t seed, ThreadPool *pool,
+                               int n_groups) {
+    static const int block_words = 16;
+    auto sorted_objs = NtkTopoSortPINode(ntk);
+    int n_pis = abc::Abc_NtkPiNum(ntk), n_pos = abc::Abc_NtkPoNum(ntk), n_obj_max = abc::Abc_NtkObjNumMax(ntk);
+    std::vector<uint64_t> pi_truth_vec((size_t) n_pis * n_words);
+    SimPIPatterns(ntk, n_words, seed, [&](int i) { return &pi_truth_vec[(size_t) i * n_words]; }, pool);
+    std::vector<int> pi_index(n_obj_max, -1);
+    for (int i = 0; i < n_pis; i++)
+        pi_index[ObjID(abc::Abc_NtkPi(ntk, i))] = i;
+
+    if (n_groups <= 0)
+        n_groups = 4 * (pool ? pool->GetSlotNum() : 1);
+    auto cones = POCones(ntk, sorted_objs);
+    auto groups = GroupCones(cones, n_obj_max, n_groups);
+
+    /* Every group simulates the union of its cones in local rows, fanins are local row indices */
+    struct ConeGroup {
+        std::vector<ObjPtr> objs;
+        std::vector<int> fanin_begin;
+        std::vector<int> fanins;
+        std::vector<int> po_rows;
+    };
+    std::vector<ConeGroup> cone_groups(groups.size());
+    std::vector<int> local(n_obj_max, -1), in_group(n_obj_max, -1);
+    std::vector<int> topo_index(n_obj_max, 0);
+    for (int i = 0; i < (int) sorted_objs.size(); i++)
+        topo_index[ObjID(sorted_objs[i])] = i;
+    for (int g = 0; g < (int) groups.size(); g++) {
+        auto &group = cone_groups[g];
+        std::vector<int> ids;
+        for (auto p : groups[g])
+            for (auto id : cones[p])
+                if (in_group[id] != g) {
+                    in_group[id] = g;
+                    ids.push_back(id);
+                }
+        std::sort(ids.begin(), ids.end(), [&](int a, int b) { return topo_index[a] < topo_index[b]; });
+        for (auto id : ids) {
+            auto obj = NtkObjbyID(ntk, id);
+            local[id] = (int) group.objs.size();
+            group.objs.push_back(obj);
+            group.fanin_begin.push_back((int) group.fanins.size());
+            for (int i = 0; i < abc::Abc_ObjFaninNum(obj); i++)
+                group.fanins.push_back(local[ObjID(abc::Abc_ObjFanin(obj, i))]);
+        }
+        group.fanin_begin.push_back((int) group.fanins.size());
+        for (auto p : groups[g])
+            group.po_rows.push_back(local[ObjID(abc::Abc_ObjFanin0(abc::Abc_NtkPo(ntk, p)))]);
+    }
+
+    /* Each group keeps its own error mask and bit-sliced mismatch counters of every word */
+    ErrorReport report;
+    report.n_patterns = 64LL * n_words;
+    report.po_err_cnt.assign(n_pos, 0);
+    report.hamming_hist.assign(n_pos + 1, 0);
+    int n_planes = 1;
+    while ((1 << n_planes) <= n_pos) n_planes++;
+    std::vector<std::vector<uint64_t>> err_any(groups.size()), planes(groups.size());
+    SimKernels block_kernels = GetSimKernels(block_words), tail_kernels = GetSimKernels(n_words % block_words);
+    auto sim_group = [&](int g, int) {
+        auto const &group = cone_groups[g];
+        err_any[g].assign(n_words, 0);
+        planes[g].assign((size_t) n_words * n_planes, 0);
+        std::vector<uint64_t> block(group.objs.size() * block_words);
+        std::vector<const uint64_t *> fanin_words;
+        for (int begin = 0; begin < n_words; begin += block_words) {
+            int n = std::min(block_words, n_words - begin);
+            auto const &kernels = n == block_words ? block_kernels : tail_kernels;
+            for (int r = 0; r < (int) group.objs.size(); r++) {
+                auto obj = group.objs[r];
+                uint64_t *row = &block[(size_t) r * block_words];
+                if (ObjIsPI(obj)) {
+                    std::copy_n(&pi_truth_vec[(size_t) pi_index[ObjID(obj)] * n_words + begin], n, row);
+                    continue;
+                }
+                fanin_words.clear();
+                for (int k = group.fanin_begin[r]; k < group.fanin_begin[r + 1]; k++)
+                    fanin_words.push_back(&block[(size_t) group.fanins[k] * block_words]);
+                SimNode(obj, fanin_words, row, n, kernels);
+            }
+            for (int j = 0; j < (int) groups[g].size(); j++) {
+                int p = groups[g][j];
+                const uint64_t *row = &block[(size_t) group.po_rows[j] * block_words];
+                const uint64_t *golden_row = &golden[(size_t) p * n_words + begin];
+                kernels.or_xor(&err_any[g][begin], row, golden_row, n);
+                report.po_err_cnt[p] += kernels.pop_xor(row, golden_row, n);
+                for (int i = 0; i < n; i++)
+                    if (uint64_t diff = row[i] ^ golden_row[i])
+                        VerticalAdd(&planes[g][(size_t) (begin + i) * n_planes], diff);
+            }
+        }
+    };
+    if (pool)
+        pool->ParallelFor((int) groups.size(), sim_group);
+    else
+        for (int g = 0; g < (int) groups.size(); g++)
+            sim_group(g, 0);
+
+    /* OR-reduce the error masks and ripple-add the counters of all groups */
+    std::vector<uint64_t> sum(n_planes);
+    for (int w = 0; w < n_words; w++) {
+        uint64_t any_err = 0;
+        std::fill(sum.begin(), sum.end(), 0);
+        for (int g = 0; g < (int) groups.size(); g++) {
+            any_err |= err_any[g][w];
+            uint64_t carry = 0;
+            for (int k = 0; k < n_planes; k++) {
+                uint64_t a = sum[k], b = planes[g][(size_t) w * n_planes + k];
+                sum[k] = a ^ b ^ carry;
+                carry = (a & b) | (carry & (a ^ b));
+            }
+        }
+        report.any_err_cnt += std::bitset<64>(any_err).count();
+        report.hamming_hist[0] += 64 - (long long) std::bitset<64>(any_err).count();
+        for (; any_err; any_err &= any_err - 1) {
+            int bit = __builtin_ctzll(any_err);
+            int distance = 0;
+            for (int k = 0; k < n_planes; k++)
+                distance |= (int) ((sum[k] >> bit) & 1) << k;
+            report.hamming_hist[distance]++;
+        }
+    }
+    return report;
+}
+
+PatternSet::PatternSet(uint64_t seed, int n_words) : seed(seed), n_words(n_words) {}
+
+bool PatternSet::operator==(const PatternSet &other) const { return seed == other.seed && n_words == other.n_words; }
+
+GoldenCache::GoldenCache() : ntk_(nullptr), n_pos_(0) {}
+
+void GoldenCache::Build(NtkPtr ntk, const PatternSet &patterns) {
+    patterns_ = patterns;
+    ntk_ = ntk;
+    n_pos_ = abc::Abc_NtkPoNum(ntk);
+    po_truth_vec_ = SimPOTruthVec(ntk, patterns.n_words, patterns.seed);
+}
+
+bool GoldenCache::IsBuilt(NtkPtr ntk, const PatternSet &patterns) const {
+    return ntk_ == ntk && patterns_ == patterns;
+}
+
+const PatternSet &GoldenCache::GetPatterns() const { return patterns_; }
+
+int GoldenCache::GetPONum() const { return n_pos_; }
+
+const uint64_t *GoldenCache::GetPOWords(int po) const { return &po_truth_vec_[(size_t) po * patterns_.n_words]; }
+
+size_t GoldenCache::GetMemBytes() const { return VectorBytes(po_truth_vec_); }
+
+/* The approximate network is simulated on the patterns of the cache, its outputs are never stored */
+ErrorReport SimGoldenErrorReport(NtkPtr approx_ntk, const GoldenCache &golden, ThreadPool *pool) {
+    return SimConeErrorReport(approx_ntk, golden.GetPOWords(0), golden.GetPatterns().n_words,
+                              golden.GetPatterns().seed, pool);
+}
+
+double SimGoldenER(NtkPtr approx_ntk, const GoldenCache &golden, ThreadPool *pool) {
+    return SimGoldenErrorReport(approx_ntk, golden, pool).GetErrorRate();
+}
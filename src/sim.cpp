@@ -0,0 +1,106 @@
+/**
+ * @file sim.cpp
+ * @brief
+ * @author Nathan Zhou
+ * @date 2019-02-14
+ * @bug No known bugs.
+ */
+
+#include <iostream>
+#include <bitset>
+#include <algorithm>
+#include <sim.h>
+
+ErrorReport::ErrorReport() : n_patterns(0), any_err_cnt(0) {}
+
+double ErrorReport::GetErrorRate() const { return (double) any_err_cnt / (double) n_patterns; }
+
+double ErrorReport::GetPOErrorRate(int po) const { return (double) po_err_cnt[po] / (double) n_patterns; }
+
+double ErrorReport::GetMeanHammingDistance() const {
+    double sum = 0;
+    for (int d = 0; d < (int) hamming_hist.size(); d++)
+        sum += (double) d * (double) hamming_hist[d];
+    return sum / (double) n_patterns;
+}
+
+void ErrorReport::Print() const {
+    double max_po_err = 0;
+    for (int p = 0; p < (int) po_err_cnt.size(); p++)
+        max_po_err = std::max(max_po_err, GetPOErrorRate(p));
+    std::cout << "Error Rate: " << GetErrorRate() << std::endl;
+    std::cout << "Max PO Error Rate: " << max_po_err << std::endl;
+    std::cout << "Mean Hamming Distance: " << GetMeanHammingDistance() << std::endl;
+}
+
+void SimNode(ObjPtr node, const std::vector<const uint64_t *> &fanin_words, uint64_t *out, int n_words,
+             const SimKernels &kernels) {
+    auto sop = (char *) abc::Abc_ObjData(node);
+    auto n_vars = (int) fanin_words.size();
+
+    // the AIG nodes are single-cube SOPs of two literals, "ab c\n"
+    if (n_vars == 2 && sop[0] != '-' && sop[1] != '-' && sop[5] == '\0') {
+        uint64_t a_mask = sop[0] == '0' ? ~(uint64_t) 0 : 0;
+        uint64_t b_mask = sop[1] == '0' ? ~(uint64_t) 0 : 0;
+        uint64_t out_mask = sop[3] == '0' ? ~(uint64_t) 0 : 0;
+        kernels.sim_and2(fanin_words[0], fanin_words[1], a_mask, b_mask, out_mask, out, n_words);
+        return;
+    }
+    for (int w = 0; w < n_words; w++)
+        out[w] = 0;
+    for (char *cube = sop; *cube; cube += n_vars + 3) {
+        for (int w = 0; w < n_words; w++) {
+            uint64_t word = ~(uint64_t) 0;
+            for (int i = 0; i < n_vars; i++) {
+                if (cube[i] == '1')
+                    word &= fanin_words[i][w];
+                else if (cube[i] == '0')
+                    word &= ~fanin_words[i][w];
+            }
+            out[w] |= word;
+        }
+    }
+    if (abc::Abc_SopIsComplement(sop))
+        for (int w = 0; w < n_words; w++)
+            out[w] = ~out[w];
+}
+
+ErrorReport SimErrorReport(const uint64_t *golden, const uint64_t *approx, int n_pos, int n_words) {
+    ErrorReport report;
+    report.n_patterns = 64LL * n_words;
+    report.po_err_cnt.assign(n_pos, 0);
+    report.hamming_hist.assign(n_pos + 1, 0);
+
+    /* Bit-sliced counters give the number of mismatching POs of all 64 patterns of a word at once */
+    int n_planes = 1;
+    while ((1 << n_planes) <= n_pos) n_planes++;
+    std::vector<uint64_t> planes(n_planes);
+    auto kernels = GetSimKernels(n_words);
+    for (int p = 0; p < n_pos; p++)
+        report.po_err_cnt[p] = kernels.pop_xor(&golden[(size_t) p * n_words], &approx[(size_t) p * n_words], n_words);
+    for (int w = 0; w < n_words; w++) {
+        std::fill(planes.begin(), planes.end(), 0);
+        uint64_t any_err = 0;
+        for (int p = 0; p < n_pos; p++) {
+            uint64_t diff = golden[(size_t) p * n_words + w] ^ approx[(size_t) p * n_words + w];
+            if (diff == 0)
+                continue;
+            any_err |= diff;
+            for (int k = 0; k < n_planes && diff; k++) {
+                uint64_t carry = planes[k] & diff;
+                planes[k] ^= diff;
+                diff = carry;
+            }
+        }
+        report.any_err_cnt += std::bitset<64>(any_err).count();
+        report.hamming_hist[0] += 64 - (long long) std::bitset<64>(any_err).count();
+        for (; any_err; any_err &= any_err - 1) {
+            int bit = __builtin_ctzll(any_err);
+            int distance = 0;
+            for (int k = 0; k < n_planes; k++)
+                distance |= (int) ((planes[k] >> bit) & 1) << k;
+            report.hamming_hist[distance]++;
+        }
+    }
+    return report;
+}
@@ -8,8 +8,11 @@
 
 #include <iostream>
 #include <queue>
+#include <algorithm>
+#include <tuple>
 #include <boost/range/adaptor/reversed.hpp>
 #include <sta.h>
+#include <mem.h>
 
 static const int INF = 1000000;
 
@@ -142,12 +145,12 @@ std::vector<Path> GetKMostCriticalPaths(const NtkPtr ntk, int k, bool print_resu
     return critical_paths;
 }
 
-std::map<int, std::set<int>> GetCriticalGraph(NtkPtr ntk) {
+CriticalGraph GetCriticalGraph(NtkPtr ntk, std::pmr::memory_resource *mr) {
     int critical_path_delay = -1;
     std::unordered_map<ObjPtr, TimeObject> time_info = CalcSlack(ntk);
     std::vector<ObjPtr> sorted_objs = NtkTopoSortPINode(ntk);
     std::unordered_map<ObjPtr, int> max_delay_to_sink;
-    std::map<int, std::set<int>> critical_graph;
+    CriticalGraph critical_graph(mr);
 
     /* Computation of Maximum Delays to Sink */
     for (auto const &obj : sorted_objs) {
@@ -197,3 +200,344 @@ std::map<int, std::set<int>> GetCriticalGraph(NtkPtr ntk) {
     }
     return critical_graph;
 }
+
+// delay to the POs of objects that reach none
+static const int NO_SINK = -1;
+
+CriticalGraphTracker::CriticalGraphTracker() : ntk_(nullptr), max_delay_(0) {}
+
+void CriticalGraphTracker::Clear() {
+    ntk_ = nullptr;
+    max_delay_ = 0;
+    alive_.clear();
+    critical_.clear();
+    arrival_.clear();
+    to_sink_.clear();
+    fanins_.clear();
+    by_length_.clear();
+    graph_.clear();
+    delta_ = CriticalGraphDelta();
+}
+
+void CriticalGraphTracker::Reset(NtkPtr ntk) {
+    Clear();
+    ntk_ = ntk;
+    auto sorted_objs = NtkTopoSortPINode(ntk);
+    Resize(abc::Abc_NtkObjNumMax(ntk));
+    for (auto const &obj : sorted_objs) {
+        int id = ObjID(obj);
+        for (auto const &fan_in : ObjFanins(obj))
+            fanins_[id].push_back(ObjID(fan_in));
+        alive_[id] = true;
+        arrival_[id] = CalcArrival(obj);
+    }
+    for (auto it = sorted_objs.rbegin(); it != sorted_objs.rend(); it++)
+        SetTiming(ObjID(*it), true, arrival_[ObjID(*it)], CalcToSink(*it));
+
+    max_delay_ = by_length_.empty() ? 0 : by_length_.rbegin()->first;
+    if (by_length_.empty())
+        return;
+    for (auto const &v : by_length_.rbegin()->second)
+        SetCritical(v);
+    for (auto const &v : by_length_.rbegin()->second)
+        for (auto const &u : fanins_[v])
+            CheckEdge(u, v);
+}
+
+const CriticalGraphDelta &CriticalGraphTracker::Update(const std::vector<int> &edited_ids,
+                                                       std::pmr::memory_resource *mr) {
+    delta_ = CriticalGraphDelta();
+    Resize(abc::Abc_NtkObjNumMax(ntk_));
+    std::pmr::vector<int> dirty(mr), forward_seeds(mr), backward_seeds(mr);
+    std::pmr::vector<std::pair<int, int>> old_edges(mr);
+    auto live_obj = [&](int id) -> ObjPtr {
+        auto obj = id < abc::Abc_NtkObjNumMax(ntk_) ? NtkObjbyID(ntk_, id) : nullptr;
+        return obj && (ObjIsPI(obj) || ObjIsNode(obj)) ? obj : nullptr;
+    };
+
+    /* Fanin changes of the edited objects, deleted objects leave the graph at once */
+    for (auto const &id : edited_ids) {
+        auto obj = live_obj(id);
+        std::vector<int> fanins;
+        if (obj)
+            for (auto const &fan_in : ObjFanins(obj))
+                fanins.push_back(ObjID(fan_in));
+        if (!obj && !alive_[id])
+            continue;
+        if (fanins != fanins_[id] || !obj) {
+            for (auto const &u : fanins_[id]) {
+                backward_seeds.push_back(u);
+                old_edges.emplace_back(u, id);
+            }
+            backward_seeds.insert(backward_seeds.end(), fanins.begin(), fanins.end());
+            fanins_[id] = fanins;
+        }
+        if (!obj) {
+            if (graph_.count(id))
+                for (auto const &w : graph_.at(id))
+                    old_edges.emplace_back(id, w);
+            SetTiming(id, false, 0, NO_SINK);
+        } else {
+            if (!alive_[id])
+                SetTiming(id, true, 0, NO_SINK);
+            forward_seeds.push_back(id);
+            backward_seeds.push_back(id);
+        }
+        dirty.push_back(id);
+    }
+
+    /* Arrival times over the fanout cone of the seeds, in the topological order of a DFS */
+    std::pmr::vector<int> order(mr);
+    std::pmr::unordered_set<int> visited(mr);
+    // the fanouts of an object are fetched once, when it is pushed
+    std::pmr::vector<std::tuple<ObjPtr, std::vector<ObjPtr>, size_t>> stack(mr);
+    for (auto const &seed : forward_seeds) {
+        if (!visited.insert(seed).second)
+            continue;
+        auto seed_obj = live_obj(seed);
+        stack.emplace_back(seed_obj, ObjFanouts(seed_obj), 0);
+        while (!stack.empty()) {
+            auto &[obj, fan_outs, i] = stack.back();
+            if (i < fan_outs.size()) {
+                auto fan_out = fan_outs[i++];
+                if (!ObjIsPO(fan_out) && visited.insert(ObjID(fan_out)).second)
+                    stack.emplace_back(fan_out, ObjFanouts(fan_out), 0);
+            } else {
+                order.push_back(ObjID(obj));
+                stack.pop_back();
+            }
+        }
+    }
+    for (auto it = order.rbegin(); it != order.rend(); it++) {
+        int arrival = CalcArrival(live_obj(*it));
+        if (arrival != arrival_[*it]) {
+            SetTiming(*it, true, arrival, to_sink_[*it]);
+            dirty.push_back(*it);
+        }
+    }
+
+    /* Delays to the POs over the fanin cone of the seeds, fanouts arrive later so they are popped first */
+    std::priority_queue<std::pair<int, int>, std::pmr::vector<std::pair<int, int>>> queue{
+            std::less<std::pair<int, int>>(), std::pmr::vector<std::pair<int, int>>(mr)};
+    std::pmr::unordered_set<int> queued(mr);
+    auto push = [&](int id) {
+        if (alive_[id] && queued.insert(id).second)
+            queue.emplace(arrival_[id], id);
+    };
+    for (auto const &seed : backward_seeds)
+        push(seed);
+    while (!queue.empty()) {
+        int v = queue.top().second;
+        queue.pop();
+        queued.erase(v);
+        int to_sink = CalcToSink(live_obj(v));
+        if (to_sink != to_sink_[v]) {
+            SetTiming(v, true, arrival_[v], to_sink);
+            dirty.push_back(v);
+            for (auto const &u : fanins_[v])
+                push(u);
+        }
+    }
+
+    /* A new critical delay changes the criticality of the old and new zero-slack objects only,
+     * the old ones whose timing changed are dirty already */
+    int max_delay = by_length_.empty() ? 0 : by_length_.rbegin()->first;
+    if (max_delay != max_delay_) {
+        for (auto const &delay : {max_delay_, max_delay})
+            if (by_length_.count(delay))
+                dirty.insert(dirty.end(), by_length_.at(delay).begin(), by_length_.at(delay).end());
+        max_delay_ = max_delay;
+    }
+    std::sort(dirty.begin(), dirty.end());
+    dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+    for (auto const &id : dirty)
+        SetCritical(id);
+    for (auto const &[u, v] : old_edges)
+        CheckEdge(u, v);
+    for (auto const &id : dirty) {
+        if (graph_.count(id)) {
+            std::pmr::vector<int> ws(graph_.at(id).begin(), graph_.at(id).end(), mr);
+            for (auto const &w : ws)
+                CheckEdge(id, w);
+        }
+        if (!alive_[id])
+            continue;
+        for (auto const &u : fanins_[id])
+            CheckEdge(u, id);
+        for (auto const &fan_out : ObjFanouts(live_obj(id)))
+            if (!ObjIsPO(fan_out))
+                CheckEdge(id, ObjID(fan_out));
+    }
+    return delta_;
+}
+
+bool CriticalGraphTracker::IsTracking(NtkPtr ntk) const { return ntk_ != nullptr && ntk_ == ntk; }
+
+int CriticalGraphTracker::GetMaxDelay() const { return max_delay_; }
+
+int CriticalGraphTracker::GetArrivalTime(int id) const { return arrival_[id]; }
+
+bool CriticalGraphTracker::IsCritical(int id) const { return critical_[id]; }
+
+TimeObject CriticalGraphTracker::GetTimeObject(int id) const {
+    int required = to_sink_[id] == NO_SINK ? INF : max_delay_ - to_sink_[id];
+    return TimeObject(arrival_[id], required, required - arrival_[id]);
+}
+
+const CriticalGraph &CriticalGraphTracker::GetCriticalGraph() const { return graph_; }
+
+const CriticalGraphDelta &CriticalGraphTracker::GetLastDelta() const { return delta_; }
+
+size_t CriticalGraphTracker::GetMemBytes() const {
+    size_t bytes = VectorBytes(arrival_) + VectorBytes(to_sink_) + VectorBytes(fanins_) +
+                   (alive_.capacity() + critical_.capacity()) / 8;
+    for (auto const &fanins : fanins_)
+        bytes += VectorBytes(fanins);
+    for (auto const &[length, ids] : by_length_)
+        bytes += HashMapBytes(ids);
+    for (auto const &[u, vs] : graph_)
+        bytes += (vs.size() + 1) * (sizeof(int) + 4 * sizeof(void *));
+    return bytes;
+}
+
+void CriticalGraphTracker::Resize(int n) {
+    if (n <= (int) arrival_.size())
+        return;
+    alive_.resize(n, false);
+    critical_.resize(n, false);
+    arrival_.resize(n, 0);
+    to_sink_.resize(n, NO_SINK);
+    fanins_.resize(n);
+}
+
+int CriticalGraphTracker::CalcArrival(ObjPtr obj) const {
+    if (ObjIsPI(obj))
+        return 1;
+    int arrival = 0;
+    for (auto const &fan_in : ObjFanins(obj))
+        arrival = std::max(arrival, arrival_[ObjID(fan_in)] + 1);
+    return arrival;
+}
+
+int CriticalGraphTracker::CalcToSink(ObjPtr obj) const {
+    int to_sink = ObjIsPONode(obj) ? 0 : NO_SINK;
+    for (auto const &fan_out : ObjFanouts(obj))
+        if (!ObjIsPO(fan_out) && to_sink_[ObjID(fan_out)] != NO_SINK)
+            to_sink = std::max(to_sink, to_sink_[ObjID(fan_out)] + 1);
+    return to_sink;
+}
+
+/* Objects that reach a PO are bucketed by the length of the longest path through them */
+void CriticalGraphTracker::SetTiming(int id, bool alive, int arrival, int to_sink) {
+    if (alive_[id] && to_sink_[id] != NO_SINK) {
+        auto &ids = by_length_.at(arrival_[id] + to_sink_[id]);
+        ids.erase(id);
+        if (ids.empty())
+            by_length_.erase(arrival_[id] + to_sink_[id]);
+    }
+    alive_[id] = alive;
+    arrival_[id] = arrival;
+    to_sink_[id] = to_sink;
+    if (alive && to_sink != NO_SINK)
+        by_length_[arrival + to_sink].insert(id);
+}
+
+void CriticalGraphTracker::SetCritical(int id) {
+    bool critical = alive_[id] && to_sink_[id] != NO_SINK && arrival_[id] + to_sink_[id] == max_delay_;
+    if (critical == critical_[id])
+        return;
+    critical_[id] = critical;
+    (critical ? delta_.added_nodes : delta_.removed_nodes).push_back(id);
+}
+
+/* u -> v is critical when both ends have zero slack and v arrives right after u */
+void CriticalGraphTracker::CheckEdge(int u, int v) {
+    bool critical = critical_[u] && critical_[v] && arrival_[v] == arrival_[u] + 1 &&
+                    std::find(fanins_[v].begin(), fanins_[v].end(), u) != fanins_[v].end();
+    auto it = graph_.find(u);
+    bool present = it != graph_.end() && it->second.count(v);
+    if (critical == present)
+        return;
+    if (critical) {
+        graph_[u].insert(v);
+        delta_.added_edges.emplace_back(u, v);
+    } else {
+        it->second.erase(v);
+        if (it->second.empty())
+            graph_.erase(it);
+        delta_.removed_edges.emplace_back(u, v);
+    }
+}
+
+void CriticalFlowGraph::Reset(NtkPtr ntk, const CriticalGraphTracker &tracker) {
+    Clear();
+    for (int id = 0; id < abc::Abc_NtkObjNumMax(ntk); id++)
+        if (tracker.IsCritical(id))
+            AddNode(id);
+    for (auto const &[u, vs] : tracker.GetCriticalGraph())
+        for (auto const &v : vs)
+            AddEdge(u, v);
+}
+
+void CriticalFlowGraph::Clear() {
+    nodes_.clear();
+    node_pos_.clear();
+    edges_.clear();
+    edge_pos_.clear();
+}
+
+void CriticalFlowGraph::Apply(const CriticalGraphDelta &delta) {
+    for (auto const &[u, v] : delta.removed_edges)
+        RemoveEdge(u, v);
+    for (auto const &id : delta.removed_nodes)
+        RemoveNode(id);
+    for (auto const &id : delta.added_nodes)
+        AddNode(id);
+    for (auto const &[u, v] : delta.added_edges)
+        AddEdge(u, v);
+}
+
+const std::vector<int> &CriticalFlowGraph::GetNodes() const { return nodes_; }
+
+const std::vector<std::pair<int, int>> &CriticalFlowGraph::GetEdges() const { return edges_; }
+
+size_t CriticalFlowGraph::GetMemBytes() const {
+    return VectorBytes(nodes_) + VectorBytes(node_pos_) + VectorBytes(edges_) + HashMapBytes(edge_pos_);
+}
+
+void CriticalFlowGraph::AddNode(int id) {
+    if (id >= (int) node_pos_.size())
+        node_pos_.resize(id + 1, -1);
+    if (node_pos_[id] != -1)
+        return;
+    node_pos_[id] = (int) nodes_.size();
+    nodes_.push_back(id);
+}
+
+/* The last node takes the place of the removed one */
+void CriticalFlowGraph::RemoveNode(int id) {
+    if (id >= (int) node_pos_.size() || node_pos_[id] == -1)
+        return;
+    int pos = node_pos_[id];
+    nodes_[pos] = nodes_.back();
+    node_pos_[nodes_[pos]] = pos;
+    nodes_.pop_back();
+    node_pos_[id] = -1;
+}
+
+void CriticalFlowGraph::AddEdge(int u, int v) {
+    if (edge_pos_.emplace(((long long) u << 32) | (unsigned) v, (int) edges_.size()).second)
+        edges_.emplace_back(u, v);
+}
+
+void CriticalFlowGraph::RemoveEdge(int u, int v) {
+    auto it = edge_pos_.find(((long long) u << 32) | (unsigned) v);
+    if (it == edge_pos_.end())
+        return;
+    int pos = it->second;
+    edge_pos_.erase(it);
+    edges_[pos] = edges_.back();
+    edges_.pop_back();
+    if (pos < (int) edges_.size())
+        edge_pos_.at(((long long) edges_[pos].first << 32) | (unsigned) edges_[pos].second) = pos;
+}
@@ -0,0 +1,118 @@
+/**
+ * @file thread_pool.cpp
+ * @brief
+ * @author Nathan Zhou
+ * @date 2019-02-27
+ * @bug No known bugs.
+ */
+
+#include <algorithm>
+#include <thread_pool.h>
+
+namespace {
+    struct WorkerInfo {
+        const ThreadPool *pool = nullptr;
+        int slot = 0;
+    };
+
+    thread_local WorkerInfo worker_info;
+}
+
+ThreadPool::ThreadPool(int n_workers) : n_queued_(0), stop_(false) {
+    n_workers_ = n_workers >= 0 ? n_workers : std::max(0, (int) std::thread::hardware_concurrency() - 1);
+    for (int i = 0; i <= n_workers_; i++)
+        queues_.emplace_back(new TaskQueue);
+    for (int i = 0; i < n_workers_; i++)
+        workers_.emplace_back(&ThreadPool::WorkerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mtx_);
+        stop_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (auto &worker : workers_)
+        worker.join();
+}
+
+int ThreadPool::GetWorkerNum() const { return n_workers_; }
+
+int ThreadPool::GetSlotNum() const { return n_workers_ + 1; }
+
+int ThreadPool::GetSlot() const { return worker_info.pool == this ? worker_info.slot : n_workers_; }
+
+void ThreadPool::Submit(std::function<void()> task) {
+    auto &queue = *queues_[GetSlot()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mtx);
+        queue.tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleep_mtx_);
+        n_queued_++;
+    }
+    sleep_cv_.notify_one();
+}
+
+bool ThreadPool::Pop(int slot, std::function<void()> &task) {
+    for (int i = 0; i <= n_workers_; i++) {
+        auto &queue = *queues_[(slot + i) % (n_workers_ + 1)];
+        std::lock_guard<std::mutex> lock(queue.mtx);
+        if (queue.tasks.empty())
+            continue;
+        // the own deque is used as a stack for locality, the others are stolen from the other end
+        if (i == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        n_queued_--;
+        return true;
+    }
+    return false;
+}
+
+bool ThreadPool::RunOne() {
+    std::function<void()> task;
+    if (!Pop(GetSlot(), task))
+        return false;
+    task();
+    return true;
+}
+
+void ThreadPool::WorkerLoop(int slot) {
+    worker_info.pool = this;
+    worker_info.slot = slot;
+    std::function<void()> task;
+    while (true) {
+        if (Pop(slot, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mtx_);
+        sleep_cv_.wait(lock, [this]() { return stop_ || n_queued_ > 0; });
+        if (stop_ && n_queued_ == 0)
+            return;
+    }
+}
+
+TaskGroup::TaskGroup(ThreadPool &pool) : pool_(pool), n_pending_(0) {}
+
+TaskGroup::~TaskGroup() { Wait(); }
+
+void TaskGroup::Run(std::function<void()> task) {
+    n_pending_++;
+    pool_.Submit([this, task = std::move(task)]() {
+        task();
+        n_pending_--;
+    });
+}
+
+void TaskGroup::Wait() {
+    while (n_pending_ > 0)
+        if (!pool_.RunOne())
+            std::this_thread::yield();
+}